@@ -0,0 +1,50 @@
+// Built_in_library
+#include <math.h>
+
+// Other_includes
+#include "constants.h"
+#include "anim.h"
+
+// The chicken's sheet: 0 chickenidle2, 1 chickenidle1, 2 chicken1, 3 chicken2 (SPRITE_CHICKEN on)
+static const AnimClip clips[ANIM_CLIPS] = {
+    { 0, 2, 2.0f, TRUE },   // Idle, a slow blink
+    { 2, 2, 8.0f, TRUE },   // Run
+    { 0, 2, 12.0f, TRUE },  // Psychic, the idle frames shaking fast
+};
+
+const AnimClip* anim_clip(int clip) {
+    return &clips[clip];
+}
+
+void anim_start(Animator* anim, int clip) {
+    anim->clip = clip;
+    anim->time = 0.0f;
+    anim->speed = 1.0f;
+}
+
+void anim_play(Animator* anim, int clip, float speed) {
+    if (anim->clip != clip) {
+        anim_start(anim, clip);
+    }
+    anim->speed = speed;
+}
+
+void anim_advance(Animator* anim, float delta_time) {
+    const AnimClip* clip = &clips[anim->clip];
+    anim->time += delta_time * anim->speed;
+
+    // Keep the time inside one loop so the float doesn't lose precision on long sessions
+    float length = clip->frames / clip->fps;
+    if (clip->loop && anim->time >= length) {
+        anim->time = fmodf(anim->time, length);
+    }
+}
+
+int anim_frame(const Animator* anim) {
+    const AnimClip* clip = &clips[anim->clip];
+    int frame = (int)(anim->time * clip->fps);
+    if (frame >= clip->frames) {
+        frame = clip->loop ? frame % clip->frames : clip->frames - 1;
+    }
+    return clip->first + frame;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Sprite-sheet animation. A clip is a run of frames in a sheet played at a fixed rate,
+// an animator is which clip is playing and how long it has been. No SDL in here: frames
+// are indices into the sheet, the renderer adds them to the sheet's first sprite, so a new
+// frame is only a different source rect in the atlas.
+//
+// Animators are advanced by update() with the tick length, so they follow the sim clock
+// (and replays) rather than the frame rate.
+
+// Clips of the chicken's sheet, see anim.c for their frames
+enum {
+    ANIM_IDLE,
+    ANIM_RUN,
+    ANIM_PSYCHIC,   // Space held, the bag speeds up
+    ANIM_CLIPS
+};
+
+typedef struct {
+    int first;      // Frame in the sheet
+    int frames;
+    float fps;
+    int loop;       // FALSE holds the last frame
+} AnimClip;
+
+typedef struct {
+    int clip;
+    float time;     // Seconds since the clip started
+    float speed;    // Playback rate, 1 is the clip's own fps
+} Animator;
+
+void anim_start(Animator* anim, int clip);
+
+// State change: restarts only when the clip is a different one, so holding a state keeps playing
+void anim_play(Animator* anim, int clip, float speed);
+
+void anim_advance(Animator* anim, float delta_time);
+
+// Frame to draw, an index into the sheet
+int anim_frame(const Animator* anim);
+
+const AnimClip* anim_clip(int clip);
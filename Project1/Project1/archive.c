@@ -0,0 +1,146 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Other_includes
+#include "constants.h"
+#include "archive.h"
+
+#ifdef _WIN32
+
+static int map_file(Archive* archive, const char* path) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return FALSE;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return FALSE;
+    }
+
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return FALSE;
+    }
+
+    archive->data = data;
+    archive->size = (size_t)size.QuadPart;
+    archive->file = file;
+    archive->mapping = mapping;
+    return TRUE;
+}
+
+static void unmap_file(Archive* archive) {
+    UnmapViewOfFile(archive->data);
+    CloseHandle(archive->mapping);
+    CloseHandle(archive->file);
+}
+
+#else
+
+static int map_file(Archive* archive, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return FALSE;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return FALSE;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return FALSE;
+    }
+
+    archive->data = data;
+    archive->size = (size_t)st.st_size;
+    return TRUE;
+}
+
+static void unmap_file(Archive* archive) {
+    munmap((void*)archive->data, archive->size);
+}
+
+#endif
+
+int archive_open(Archive* archive, const char* path) {
+    memset(archive, 0, sizeof(*archive));
+
+    if (!map_file(archive, path)) {
+        return FALSE;
+    }
+
+    // Check everything up front so lookups can trust the index
+    const ArchiveHeader* header = (const ArchiveHeader*)archive->data;
+    int valid = archive->size >= sizeof(ArchiveHeader) &&
+        memcmp(header->magic, ARCHIVE_MAGIC, 4) == 0 &&
+        header->version == ARCHIVE_VERSION &&
+        header->count <= (archive->size - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry);
+
+    if (valid) {
+        archive->entries = (const ArchiveEntry*)(archive->data + sizeof(ArchiveHeader));
+        archive->count = (int)header->count;
+
+        for (int i = 0; i < archive->count && valid; i++) {
+            const ArchiveEntry* entry = &archive->entries[i];
+            valid = entry->offset <= archive->size &&
+                entry->size <= archive->size - entry->offset &&
+                (uint64_t)entry->pitch * entry->height <= entry->size &&
+                memchr(entry->name, '\0', ARCHIVE_NAME_LENGTH) != NULL;
+        }
+    }
+
+    if (!valid) {
+        fprintf(stderr, "Archive %s is damaged or from another version, ignoring it\n", path);
+        archive_close(archive);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void archive_close(Archive* archive) {
+    if (archive->data) {
+        unmap_file(archive);
+    }
+    memset(archive, 0, sizeof(*archive));
+}
+
+const ArchiveEntry* archive_find(const Archive* archive, const char* name) {
+    for (int i = 0; i < archive->count; i++) {
+        if (strcmp(archive->entries[i].name, name) == 0) {
+            return &archive->entries[i];
+        }
+    }
+    return NULL;
+}
+
+const void* archive_pixels(const Archive* archive, const ArchiveEntry* entry) {
+    return archive->data + entry->offset;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Asset archive: pre-decoded images in one file, written offline by pack.c.
+// The file is memory-mapped and the pixels are used in place, so loading an
+// image costs a lookup instead of a PNG decode. No SDL in here.
+//
+// Layout (little endian):
+//   ArchiveHeader
+//   ArchiveEntry[count]
+//   pixel data, each image starting on an ARCHIVE_ALIGN boundary
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Archive the game looks for, the PNGs are used when it's missing
+#define ASSET_ARCHIVE "assets/assets.pak"
+
+#define ARCHIVE_MAGIC "PCPK"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_NAME_LENGTH 64
+#define ARCHIVE_ALIGN 64
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+} ArchiveHeader;
+
+typedef struct {
+    char name[ARCHIVE_NAME_LENGTH];  // Path of the source file, e.g. "assets/egg.png"
+    uint32_t width, height;
+    uint32_t pitch;                  // Bytes per row
+    uint32_t format;                 // SDL_PixelFormatEnum of the pixels
+    uint64_t offset;                 // From the start of the file
+    uint64_t size;
+} ArchiveEntry;
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    const ArchiveEntry* entries;
+    int count;
+
+    void* file;         // Platform handles for the mapping
+    void* mapping;
+} Archive;
+
+// Maps the file and checks the index, returns FALSE if it's missing or broken
+int archive_open(Archive* archive, const char* path);
+void archive_close(Archive* archive);
+
+// NULL when the archive doesn't have it
+const ArchiveEntry* archive_find(const Archive* archive, const char* name);
+const void* archive_pixels(const Archive* archive, const ArchiveEntry* entry);
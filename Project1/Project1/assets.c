@@ -0,0 +1,23 @@
+// Built_in_library
+#include <stddef.h>
+
+// Other_includes
+#include "assets.h"
+
+// Files for the SPRITE_* ids, SPRITE_WHITE is generated
+static const char* sprite_files[SPRITE_COUNT] = {
+    "assets/forest_bg.png",
+    "assets/bag.png",
+    "assets/chickenidle2.png",
+    "assets/chickenidle1.png",
+    "assets/chicken1.png",
+    "assets/chicken2.png",
+    "assets/egg.png",
+    "assets/remains.png",
+    "assets/eggGolden.png",
+    NULL
+};
+
+const char* assets_sprite_file(int sprite) {
+    return sprite_files[sprite];
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Sprite ids and the files they're loaded from. No SDL in here, so the game, the headless
+// renderer (raster.c) and the offline packer (pack.c) all work from the one list.
+
+enum {
+    SPRITE_BACKGROUND,
+    SPRITE_BAG,
+    SPRITE_CHICKEN,         // The chicken's sheet, anim.h frames count from here
+    SPRITE_CHICKEN_IDLE,
+    SPRITE_CHICKEN_RUN1,
+    SPRITE_CHICKEN_RUN2,
+    SPRITE_EGG,
+    SPRITE_REMAINS,     // Shell bits, for splat particles
+    SPRITE_GOLDEN_EGG,  // Sparkles
+    SPRITE_WHITE,       // 1x1 white texel, for solid color rects
+    SPRITE_COUNT
+};
+
+// File a sprite is loaded from, NULL for generated ones
+const char* assets_sprite_file(int sprite);
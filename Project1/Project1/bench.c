@@ -0,0 +1,869 @@
+#define _CRT_SECURE_NO_WARNINGS
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+
+// Headless benchmark: runs the game logic with no window, renderer or SDL_image / SDL_ttf
+// and reports simulated ticks per second for a grid of object counts and levels.
+//
+// Usage: bench [--seed N] [--ticks N] [--hz N] [--objects 10,1000,...] [--levels 1,5,...] [--threads 1,4,...]
+//              [--script FILE] [--profile]
+// bench --particles N [--ticks N] [--hz N]
+//   keeps about N particles alive and times particles_update() instead of the game
+// bench --envs N [--ticks N] [--hz N] [--seed N] [--threads 1,4,...]
+//   steps N training envs (env.h) with random buttons and reports env steps per second
+// bench --rewind SECONDS [--ticks N] [--hz N] [--seed N] [--script FILE]
+//   plays the script keeping SECONDS of rewind history, reports its size and restore time, then
+//   rewinds a few times, plays the same inputs again and checks the checksums match the first time
+// bench --pace HZ
+//   runs three seconds of fake frames at HZ with the old whole-millisecond delay and with the
+//   software cap in pacer.h, and prints the frame rate, jitter and missed deadlines of each
+// bench --render FRAMES [--size WxH] [--objects N] [--seed N] [--hz N] [--script FILE] [--threads 1,4,...] [--golden FILE]
+//   plays the script one tick per frame and draws FRAMES frames of it in software (raster.h), world,
+//   particles and HUD, and reports pixels per second. --golden puts the last frame, the same frame
+//   paused and the game over screen one above the other and compares them with a PPM file, or
+//   writes it when there's none yet
+//
+// --threads runs every row once per thread count (default 1 and one per core), with the speedup over the first.
+// --profile times the update() phases, one profiler frame per tick, and prints p50 / p99 for each run.
+//
+// bench --record FILE [--seed N] [--ticks N] [--hz N] [--script FILE]
+//   plays the script as one game session (restarting after a game over like the game does) and saves the replay
+// bench --replay FILE
+//   runs a replay recorded here or in the game at full speed and checks its checksums
+//
+// Recording and replaying use the last --threads value, a replay must check out whatever the thread count.
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Other_includes
+#include "game.h"
+#include "env.h"
+#include "jobs.h"
+#include "pacer.h"
+#include "particles.h"
+#include "profiler.h"
+#include "raster.h"
+#include "replay.h"
+#include "rewind.h"
+#include "archive.h"
+
+#define MAX_LIST 16
+#define MAX_SCRIPT_STEPS 256
+
+typedef struct {
+    int ticks;            // How long the buttons are held
+    unsigned int input;   // INPUT_* buttons
+} ScriptStep;
+
+typedef struct {
+    ScriptStep steps[MAX_SCRIPT_STEPS];
+    int num_steps;
+    int total_ticks;
+} Script;
+
+// Default input script, one "<ticks> <buttons>" pair per line, A / D / S(hift) / B(oost) or - for nothing
+static const char* default_script =
+    "90 D\n"
+    "30 DS\n"
+    "20 -\n"
+    "120 A\n"
+    "40 AB\n"
+    "60 DB\n"
+    "30 -\n"
+    "45 AS\n";
+
+static double now_seconds() {
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static int parse_list(const char* text, int* values) {
+    int count = 0;
+    while (*text && count < MAX_LIST) {
+        values[count++] = atoi(text);
+        const char* comma = strchr(text, ',');
+        if (!comma) break;
+        text = comma + 1;
+    }
+    return count;
+}
+
+static unsigned int parse_buttons(const char* text) {
+    unsigned int input = 0;
+    for (; *text; text++) {
+        switch (*text) {
+        case 'A': case 'a': input |= INPUT_LEFT; break;
+        case 'D': case 'd': input |= INPUT_RIGHT; break;
+        case 'S': case 's': input |= INPUT_FAST; break;
+        case 'B': case 'b': input |= INPUT_BOOST; break;
+        }
+    }
+    return input;
+}
+
+static int parse_script(const char* text, Script* script) {
+    script->num_steps = 0;
+    script->total_ticks = 0;
+
+    while (*text && script->num_steps < MAX_SCRIPT_STEPS) {
+        char buttons[32] = "";
+        int ticks = 0;
+
+        if (sscanf(text, "%d %31s", &ticks, buttons) >= 1 && ticks > 0) {
+            ScriptStep* step = &script->steps[script->num_steps++];
+            step->ticks = ticks;
+            step->input = parse_buttons(buttons);
+            script->total_ticks += ticks;
+        }
+
+        const char* newline = strchr(text, '\n');
+        if (!newline) break;
+        text = newline + 1;
+    }
+
+    return script->num_steps > 0;
+}
+
+static int load_script(const char* path, Script* script) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open script %s\n", path);
+        return FALSE;
+    }
+
+    static char buffer[16384];
+    size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+    buffer[length] = '\0';
+    fclose(file);
+
+    return parse_script(buffer, script);
+}
+
+// Buttons held at a given tick, the script loops
+static unsigned int script_input(const Script* script, long tick) {
+    long t = tick % script->total_ticks;
+    for (int i = 0; i < script->num_steps; i++) {
+        if (t < script->steps[i].ticks) return script->steps[i].input;
+        t -= script->steps[i].ticks;
+    }
+    return 0;
+}
+
+// Same rules as the game loop in main.c: a game over restarts from level 1, a level up just carries on
+static void continue_session(Game* game) {
+    if (game->is_game_over) {
+        reset_game(game);
+    }
+    game->level_complete = 0;
+}
+
+static void bench_config(GameConfig* config) {
+    game_default_config(config);
+    config->quiet = 1;
+    config->ball_width = BAG_WIDTH;
+    config->ball_height = BAG_HEIGHT;
+    config->block_width = CHICKEN_WIDTH;
+    config->block_height = CHICKEN_HEIGHT;
+}
+
+static int record_session(const char* path, unsigned int seed, long ticks, int hz, const Script* script) {
+    GameConfig config;
+    bench_config(&config);
+
+    Replay replay;
+    replay_init(&replay, seed, hz, &config);
+
+    Game game;
+    if (!game_init(&game, &config)) {
+        return 1;
+    }
+    game_seed(&game, seed);
+    setup(&game);
+
+    for (long tick = 0; tick < ticks; tick++) {
+        unsigned int input = script_input(script, tick);
+        store_previous_state(&game);
+        update(&game, input, 1.0f / hz);
+        replay_record(&replay, input, game_checksum(&game));
+        continue_session(&game);
+    }
+
+    int ok = replay_save(&replay, path);
+    printf("Recorded %u ticks in %u runs to %s\n", replay.header.num_ticks, replay.header.num_runs, path);
+
+    replay_free(&replay);
+    game_free(&game);
+    return ok ? 0 : 1;
+}
+
+static int play_replay(const char* path) {
+    Replay replay;
+    if (!replay_load(&replay, path)) {
+        return 1;
+    }
+
+    GameConfig config;
+    replay_config(&replay, &config);
+    config.quiet = 1;
+
+    Game game;
+    if (!game_init(&game, &config)) {
+        return 1;
+    }
+    game_seed(&game, replay.header.seed);
+    setup(&game);
+
+    const float dt = 1.0f / replay.header.sim_hz;
+    unsigned int input;
+    double start = now_seconds();
+    while (replay_next(&replay, &input)) {
+        store_previous_state(&game);
+        update(&game, input, dt);
+        replay_check(&replay, game_checksum(&game));
+        continue_session(&game);
+    }
+    double elapsed = now_seconds() - start;
+
+    printf("Replayed %u ticks at %u Hz, seed %u: %.0f ticks/s, %u checksums, %d mismatched\n",
+        replay.tick, replay.header.sim_hz, replay.header.seed,
+        replay.tick / elapsed, replay.header.num_checksums, replay.mismatches);
+
+    int result = replay.mismatches ? 1 : 0;
+    replay_free(&replay);
+    game_free(&game);
+    return result;
+}
+
+// Splat bursts every tick, enough to keep about count particles alive
+static int bench_particles(int count, long ticks, int hz) {
+    Particles particles;
+    if (!particles_init(&particles, count)) {
+        return 1;
+    }
+
+    const float dt = 1.0f / hz;
+    const int burst = 12;
+    long bursts = 0;
+    long moved = 0;
+    double start = now_seconds();
+    for (long tick = 0; tick < ticks; tick++) {
+        while (particles_count(&particles) + burst <= count) {
+            particles_emit(&particles, PARTICLE_SHELL, (float)(tick % WINDOW_WIDTH), (float)WINDOW_HEIGHT, burst);
+            bursts++;
+        }
+        moved += particles_count(&particles);
+        particles_update(&particles, dt);
+    }
+    double elapsed = now_seconds() - start;
+
+    printf("%d particles (ring of %d), %ld ticks at %d Hz: %.0f ns/tick, %.2f ns/particle, %ld bursts\n",
+        count, particles.capacity, ticks, hz, elapsed * 1e9 / ticks, moved ? elapsed * 1e9 / moved : 0.0, bursts);
+
+    particles_free(&particles);
+    return 0;
+}
+
+static void busy_wait(double seconds) {
+    double end = now_seconds() + seconds;
+    while (now_seconds() < end) {
+        // Stands in for drawing a frame
+    }
+}
+
+static void sleep_ms(unsigned int ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+// Same fake frames (a quarter to half of the interval of work) through the game's old frame cap,
+// a delay of the whole milliseconds left of 1000 / hz, and through the pacer's software cap
+static int bench_pace(int hz) {
+    const int frames = hz * 3;
+    const double interval = 1.0 / hz;
+
+    Pacer delay;
+    pacer_init(&delay, PACE_UNCAPPED, hz);
+    for (int frame = 0; frame < frames; frame++) {
+        double start = now_seconds();
+        busy_wait(interval * (frame % 2 ? 0.5 : 0.25));
+        double elapsed = now_seconds() - start;
+        double target = (1000 / hz) / 1000.0;
+        if (elapsed < target) {
+            sleep_ms((unsigned int)((target - elapsed) * 1000.0));
+        }
+        pacer_frame_end(&delay);
+    }
+
+    Pacer cap;
+    pacer_init(&cap, PACE_CAP, hz);
+    for (int frame = 0; frame < frames; frame++) {
+        busy_wait(interval * (frame % 2 ? 0.5 : 0.25));
+        pacer_frame_end(&cap);
+    }
+
+    printf("%d frames at %d Hz (%.3f ms)\n", frames, hz, interval * 1000.0);
+    printf("  method        rate Hz   mean ms  jitter ms  worst ms  missed\n");
+    const Pacer* runs[2] = { &delay, &cap };
+    const char* names[2] = { "delay", "pacer" };
+    for (int i = 0; i < 2; i++) {
+        double mean, jitter, worst;
+        pacer_stats(runs[i], &mean, &jitter, &worst);
+        printf("  %-8s %12.2f %9.3f %10.3f %9.3f %7lu\n", names[i], mean > 0.0 ? 1000.0 / mean : 0.0, mean, jitter, worst, runs[i]->missed);
+    }
+    printf("  pacer spin window %.3f ms\n", cap.spin * 1000.0);
+    return 0;
+}
+
+// Plays ticks [from, ticks) of the script with the rewind history on, checking the checksums
+// against the ones from the first time through. Returns the mismatches.
+static long play_rewound(Game* game, Rewind* history, const Script* script, long from, long ticks, int hz,
+    unsigned int* checksums, double* record_seconds) {
+    long mismatches = 0;
+    for (long tick = from; tick < ticks; tick++) {
+        update(game, script_input(script, tick), 1.0f / hz);
+        continue_session(game);
+
+        unsigned int checksum = game_checksum(game);
+        if (checksums[tick] != checksum) mismatches++;
+        checksums[tick] = checksum;
+
+        double start = now_seconds();
+        rewind_record(history, game, (unsigned int)tick);
+        *record_seconds += now_seconds() - start;
+    }
+    return mismatches;
+}
+
+static int bench_rewind(int seconds, long ticks, int hz, unsigned int seed, const Script* script) {
+    GameConfig config;
+    bench_config(&config);
+
+    Game game;
+    Rewind history;
+    unsigned int* checksums = malloc(sizeof(unsigned int) * ticks);
+    if (!checksums || !game_init(&game, &config)) {
+        free(checksums);
+        return 1;
+    }
+    if (!rewind_init(&history, &config, REWIND_DEFAULT_BYTES, seconds * hz)) {
+        free(checksums);
+        game_free(&game);
+        return 1;
+    }
+    game_seed(&game, seed);
+    setup(&game);
+
+    // First time through only fills in the checksums
+    memset(checksums, 0, sizeof(unsigned int) * ticks);
+    double record_seconds = 0.0;
+    play_rewound(&game, &history, script, 0, ticks, hz, checksums, &record_seconds);
+
+    int held = rewind_tick_count(&history);
+    size_t used = rewind_used_bytes(&history);
+    printf("seed %u, %ld ticks at %d Hz, %zu KB ring, %zu byte state images at most\n",
+        seed, ticks, hz, (size_t)REWIND_DEFAULT_BYTES / 1024, game_state_max_size(&config));
+    printf("History: %d ticks (%.1f s) in %zu KB, %.1f bytes per tick, %.0f ns per record\n",
+        held, (double)held / hz, used / 1024, held ? (double)used / held : 0.0, record_seconds * 1e9 / ticks);
+
+    // Rewind, then play the same inputs again: the history must bring back the exact state
+    int backs[3] = { held - 1, held / 2, hz };
+    long mismatches = 0;
+    for (int r = 0; r < 3; r++) {
+        double start = now_seconds();
+        long tick = rewind_restore(&history, &game, backs[r]);
+        double elapsed = now_seconds() - start;
+        if (tick < 0) {
+            printf("Rewind: nothing to restore\n");
+            mismatches++;
+            break;
+        }
+
+        long replayed = play_rewound(&game, &history, script, tick + 1, ticks, hz, checksums, &record_seconds);
+        mismatches += replayed;
+        printf("Rewind %5d ticks to tick %7ld: restored in %6.2f us, %ld checksum mismatches playing it again\n",
+            backs[r], tick, elapsed * 1e6, replayed);
+    }
+
+    rewind_free(&history);
+    game_free(&game);
+    free(checksums);
+    return mismatches ? 1 : 0;
+}
+
+// Random buttons for every env each tick, only env_step() is timed
+static int bench_envs(int num_envs, long ticks, int hz, unsigned int seed, const int* thread_counts, int num_thread_counts) {
+    GameConfig config;
+    bench_config(&config);
+
+    float* observations = malloc(sizeof(float) * ENV_OBS_SIZE * num_envs);
+    float* rewards = malloc(sizeof(float) * num_envs);
+    unsigned char* dones = malloc(num_envs);
+    unsigned int* actions = malloc(sizeof(unsigned int) * num_envs);
+    if (!observations || !rewards || !dones || !actions) {
+        fprintf(stderr, "Error: Could not allocate buffers for %d envs\n", num_envs);
+        free(observations); free(rewards); free(dones); free(actions);
+        return 1;
+    }
+
+    printf("%d envs, seed %u, %ld ticks per run at %d Hz, %d floats per observation\n", num_envs, seed, ticks, hz, ENV_OBS_SIZE);
+    printf("%7s %16s %10s %8s %10s %12s\n", "threads", "env steps/s", "ns/step", "speedup", "gameovers", "reward");
+
+    int result = 0;
+    double base_rate = 0.0;
+    for (int t = 0; t < num_thread_counts; t++) {
+        int threads = jobs_init(thread_counts[t]);
+
+        Env env;
+        if (!env_create(&env, num_envs, &config, hz)) {
+            result = 1;
+            jobs_shutdown();
+            break;
+        }
+        env_bind(&env, observations, rewards, dones);
+        env_reset(&env, seed);
+
+        Rng rng;
+        rng_seed(&rng, seed, RNG_STREAM_SPAWN);
+        long game_overs = 0;
+        double total_reward = 0.0;
+        double elapsed = 0.0;
+        for (long tick = 0; tick < ticks; tick++) {
+            for (int i = 0; i < num_envs; i++) {
+                actions[i] = rng_below(&rng, 16);
+            }
+
+            double start = now_seconds();
+            env_step(&env, actions);
+            elapsed += now_seconds() - start;
+
+            for (int i = 0; i < num_envs; i++) {
+                game_overs += dones[i];
+                total_reward += rewards[i];
+            }
+        }
+
+        double rate = (double)ticks * num_envs / elapsed;
+        if (t == 0) base_rate = rate;
+        printf("%7d %16.0f %10.1f %7.2fx %10ld %12.0f\n", threads, rate, 1e9 / rate, rate / base_rate, game_overs, total_reward);
+
+        env_destroy(&env);
+        jobs_shutdown();
+    }
+
+    free(observations);
+    free(rewards);
+    free(dones);
+    free(actions);
+    return result;
+}
+
+// Snapshot with its own egg arrays, for scene_copy() to fill like the sim thread does
+static int alloc_snapshot(Snapshot* snapshot, int capacity) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    float* arrays = malloc(sizeof(float) * 6 * (capacity > 0 ? capacity : 1));
+    if (!arrays) {
+        fprintf(stderr, "Error: Could not allocate a snapshot of %d eggs\n", capacity);
+        return FALSE;
+    }
+    snapshot->prev_x = arrays;
+    snapshot->prev_y = arrays + capacity;
+    snapshot->x = arrays + 2 * capacity;
+    snapshot->y = arrays + 3 * capacity;
+    snapshot->width = arrays + 4 * capacity;
+    snapshot->height = arrays + 5 * capacity;
+    return TRUE;
+}
+
+// FNV-1a over the framebuffer, to check every thread count drew the same bytes
+static unsigned int hash_pixels(const unsigned char* pixels, size_t size) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ pixels[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Plays the script in a new game, one tick and one frame at a time, and times only the drawing.
+// Leaves the last frame's snapshot and particles behind. Returns a negative time on failure.
+static double render_run(Raster* raster, const GameConfig* config, Snapshot* snapshot, Particles* particles,
+    int frames, unsigned int seed, int hz, const Script* script, long* blits) {
+    Game game;
+    if (!game_init(&game, config)) {
+        return -1.0;
+    }
+    game_seed(&game, seed);
+    setup(&game);
+
+    // Same bursts every run, or the thread counts can't be compared
+    particles_clear(particles);
+    rng_seed(&particles->rng, seed, RNG_STREAM_PARTICLES);
+
+    const float dt = 1.0f / hz;
+    double elapsed = 0.0;
+    *blits = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        store_previous_state(&game);
+        update(&game, script_input(script, frame), dt);
+        scene_copy(snapshot, &game, config->capacity);
+        scene_emit_particles(particles, game.events, game.num_events);
+        particles_update(particles, dt);
+        continue_session(&game);
+
+        double start = now_seconds();
+        raster_begin(raster);
+        scene_draw_world(&raster->canvas, snapshot, 0.5f, particles);
+        scene_draw_hud(&raster->canvas, snapshot);
+        *blits += raster->num_blits;
+        raster_finish(raster);
+        elapsed += now_seconds() - start;
+    }
+
+    game_free(&game);
+    return elapsed;
+}
+
+// The last frame, paused and game over, stacked. Missing golden files are written, not failed.
+static int check_golden(Raster* raster, const Snapshot* snapshot, const Particles* particles, const char* path) {
+    size_t frame_bytes = (size_t)raster->width * raster->height * 4;
+    int height = raster->height * 3;
+    unsigned char* image = malloc(frame_bytes * 3);
+    if (!image) {
+        return 1;
+    }
+
+    for (int screen = 0; screen < 3; screen++) {
+        raster_begin(raster);
+        if (screen < 2) {
+            scene_draw_world(&raster->canvas, snapshot, 0.5f, particles);
+            scene_draw_hud(&raster->canvas, snapshot);
+            if (screen == 1) scene_draw_paused(&raster->canvas);
+        }
+        else {
+            scene_draw_background(&raster->canvas);
+            scene_draw_game_over(&raster->canvas, snapshot);
+        }
+        raster_finish(raster);
+        memcpy(image + frame_bytes * screen, raster->pixels, frame_bytes);
+    }
+
+    int golden_width, golden_height;
+    unsigned char* golden = raster_read_ppm(path, &golden_width, &golden_height);
+    if (!golden) {
+        int ok = raster_write_ppm(path, image, raster->width, height);
+        if (ok) printf("Golden: wrote %s (%dx%d)\n", path, raster->width, height);
+        free(image);
+        return ok ? 0 : 1;
+    }
+
+    long differ = 0;
+    int max_diff = 0;
+    if (golden_width != raster->width || golden_height != height) {
+        printf("Golden: %s is %dx%d, the frames are %dx%d\n", path, golden_width, golden_height, raster->width, height);
+        differ = 1;
+    }
+    else {
+        for (size_t i = 0; i < (size_t)raster->width * height; i++) {
+            int pixel_diff = 0;
+            for (int c = 0; c < 3; c++) {
+                int diff = abs(image[i * 4 + c] - golden[i * 4 + c]);
+                if (diff > pixel_diff) pixel_diff = diff;
+            }
+            if (pixel_diff) differ++;
+            if (pixel_diff > max_diff) max_diff = pixel_diff;
+        }
+        printf("Golden: %ld of %d pixels differ from %s, by %d at most\n", differ, raster->width * height, path, max_diff);
+    }
+
+    // What came out this time next to the golden, to look at or to replace it with
+    if (differ) {
+        char actual_path[1024];
+        snprintf(actual_path, sizeof(actual_path), "%s.new.ppm", path);
+        if (raster_write_ppm(actual_path, image, raster->width, height)) {
+            printf("Golden: wrote %s\n", actual_path);
+        }
+    }
+
+    free(golden);
+    free(image);
+    return differ ? 1 : 0;
+}
+
+static int bench_render(int frames, int width, int height, int objects, unsigned int seed, int hz, const Script* script,
+    const int* thread_counts, int num_thread_counts, const char* golden_path) {
+    GameConfig config;
+    bench_config(&config);
+    if (objects > 0) {
+        config.capacity = objects;
+        config.egg_count = objects;
+    }
+
+    Raster raster;
+    Snapshot snapshot;
+    Particles particles;
+    if (!raster_init(&raster, width, height, ASSET_ARCHIVE)) {
+        return 1;
+    }
+    if (!alloc_snapshot(&snapshot, config.capacity)) {
+        raster_free(&raster);
+        return 1;
+    }
+    if (!particles_init(&particles, PARTICLE_CAPACITY)) {
+        free(snapshot.prev_x);
+        raster_free(&raster);
+        return 1;
+    }
+
+    printf("%d frames at %dx%d, seed %u, %d eggs, %s sprites, %s blend kernel\n",
+        frames, width, height, seed, config.capacity, raster.from_archive ? ASSET_ARCHIVE : "stand-in", raster_kernel_name());
+    printf("%7s %12s %10s %14s %8s %12s %10s\n", "threads", "frames/s", "ms/frame", "Mpixels/s", "speedup", "blits/frame", "hash");
+
+    int result = 0;
+    double base_rate = 0.0;
+    unsigned int first_hash = 0;
+    for (int t = 0; t < num_thread_counts; t++) {
+        int threads = jobs_init(thread_counts[t]);
+
+        long blits;
+        double elapsed = render_run(&raster, &config, &snapshot, &particles, frames, seed, hz, script, &blits);
+        if (elapsed < 0.0) {
+            result = 1;
+            break;
+        }
+        unsigned int hash = hash_pixels(raster.pixels, (size_t)width * height * 4);
+
+        double rate = frames / elapsed;
+        if (t == 0) {
+            base_rate = rate;
+            first_hash = hash;
+        }
+        printf("%7d %12.1f %10.3f %14.1f %7.2fx %12.1f %10x\n", threads, rate, 1000.0 / rate,
+            rate * width * height / 1e6, rate / base_rate, (double)blits / frames, hash);
+
+        // Bands never share pixels, so the thread count mustn't change a byte
+        if (hash != first_hash) {
+            printf("Render: %d threads drew a different frame\n", threads);
+            result = 1;
+        }
+
+        // Last run's frame is the one checked against the golden
+        if (t < num_thread_counts - 1) {
+            jobs_shutdown();
+        }
+    }
+
+    if (result == 0 && golden_path && check_golden(&raster, &snapshot, &particles, golden_path)) {
+        result = 1;
+    }
+    jobs_shutdown();
+
+    free(snapshot.prev_x);
+    particles_free(&particles);
+    raster_free(&raster);
+    return result;
+}
+
+// Puts the game at the start of a level the way a level up in the game does. setup() sizes
+// the eggs by the level and puts the speeds back to level 1's, so only the egg count grows.
+static void start_level(Game* game, int level) {
+    game->current_level = level;
+    setup(game);
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int seed = 12345;
+    long ticks = 20000;
+    int hz = SIM_HZ;
+    int object_counts[MAX_LIST] = { 10, 1000, 100000 };
+    int num_object_counts = 3;
+    int levels[MAX_LIST] = { 1, 5, 10 };
+    int num_levels = 3;
+    int thread_counts[MAX_LIST] = { 1, jobs_core_count() };
+    int num_thread_counts = thread_counts[1] > 1 ? 2 : 1;
+    const char* script_path = NULL;
+    const char* record_path = NULL;
+    const char* replay_path = NULL;
+    int num_particles = 0;
+    int num_envs = 0;
+    int rewind_seconds = 0;
+    int pace_hz = 0;
+    int render_frames = 0;
+    int render_width = WINDOW_WIDTH;
+    int render_height = WINDOW_HEIGHT;
+    int render_objects = 0;
+    const char* golden_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--profile") == 0) profiler_enabled = TRUE;
+        else if (!has_value) break;
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--ticks") == 0) ticks = atol(argv[++i]);
+        else if (strcmp(argv[i], "--hz") == 0) hz = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--objects") == 0) {
+            num_object_counts = parse_list(argv[++i], object_counts);
+            render_objects = object_counts[0];
+        }
+        else if (strcmp(argv[i], "--levels") == 0) num_levels = parse_list(argv[++i], levels);
+        else if (strcmp(argv[i], "--threads") == 0) num_thread_counts = parse_list(argv[++i], thread_counts);
+        else if (strcmp(argv[i], "--script") == 0) script_path = argv[++i];
+        else if (strcmp(argv[i], "--record") == 0) record_path = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0) replay_path = argv[++i];
+        else if (strcmp(argv[i], "--particles") == 0) num_particles = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--envs") == 0) num_envs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rewind") == 0) rewind_seconds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--pace") == 0) pace_hz = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--render") == 0) render_frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--size") == 0) sscanf(argv[++i], "%dx%d", &render_width, &render_height);
+        else if (strcmp(argv[i], "--golden") == 0) golden_path = argv[++i];
+    }
+
+    if (profiler_enabled) {
+        profiler_init();
+    }
+
+    if (replay_path) {
+        jobs_init(thread_counts[num_thread_counts - 1]);
+        int result = play_replay(replay_path);
+        jobs_shutdown();
+        return result;
+    }
+
+    if (pace_hz > 0) {
+        return bench_pace(pace_hz);
+    }
+
+    if (hz < MIN_SIM_HZ) hz = MIN_SIM_HZ;
+    if (hz > MAX_SIM_HZ) hz = MAX_SIM_HZ;
+    if (ticks < 1) ticks = 1;
+
+    if (num_particles > 0) {
+        return bench_particles(num_particles, ticks, hz);
+    }
+    if (num_envs > 0) {
+        return bench_envs(num_envs, ticks, hz, seed, thread_counts, num_thread_counts);
+    }
+
+    Script script;
+    if (script_path ? !load_script(script_path, &script) : !parse_script(default_script, &script)) {
+        fprintf(stderr, "Error: Empty input script\n");
+        return 1;
+    }
+
+    if (rewind_seconds > 0) {
+        return bench_rewind(rewind_seconds, ticks, hz, seed, &script);
+    }
+
+    if (render_frames > 0) {
+        if (render_width < 1 || render_height < 1) {
+            fprintf(stderr, "Error: Bad --size %dx%d\n", render_width, render_height);
+            return 1;
+        }
+        return bench_render(render_frames, render_width, render_height, render_objects, seed, hz, &script,
+            thread_counts, num_thread_counts, golden_path);
+    }
+
+    if (record_path) {
+        jobs_init(thread_counts[num_thread_counts - 1]);
+        int result = record_session(record_path, seed, ticks, hz, &script);
+        jobs_shutdown();
+        return result;
+    }
+
+    const float dt = 1.0f / hz;
+
+    printf("seed %u, %ld ticks per run at %d Hz, %s egg kernel\n", seed, ticks, hz, eggs_kernel_name());
+    printf("%8s %6s %8s %7s %14s %10s %8s %8s %10s %9s\n", "objects", "level", "eggs", "threads", "ticks/s", "ns/tick", "speedup", "allocs", "gameovers", "levelups");
+
+    for (int o = 0; o < num_object_counts; o++) {
+        for (int l = 0; l < num_levels; l++) {
+            double base_rate = 0.0;
+            for (int t = 0; t < num_thread_counts; t++) {
+                int threads = jobs_init(thread_counts[t]);
+
+                // Objects is the level 1 count, later levels get more eggs like in the game
+                GameConfig config;
+                bench_config(&config);
+                config.egg_count = object_counts[o];
+                config.capacity = game_egg_count(&config, levels[l]);
+
+                Game game;
+                if (!game_init(&game, &config)) {
+                    return 1;
+                }
+
+                // Same seed for every run so each row sees the same egg layout
+                game_seed(&game, seed);
+                start_level(&game, levels[l]);
+
+                size_t allocations_before = game_allocation_count();
+                long game_overs = 0;
+                long level_ups = 0;
+
+                double start = now_seconds();
+                for (long tick = 0; tick < ticks; tick++) {
+                    if (profiler_enabled) profiler_frame_begin();
+
+                    store_previous_state(&game);
+                    update(&game, script_input(&script, tick), dt);
+
+                    if (profiler_enabled) profiler_frame_end();
+
+                    // Stay on the level being measured
+                    if (game.is_game_over) {
+                        game_overs++;
+                        start_level(&game, levels[l]);
+                    }
+                    else if (game.current_level != levels[l]) {
+                        level_ups++;
+                        start_level(&game, levels[l]);
+                    }
+                }
+                double elapsed = now_seconds() - start;
+
+                size_t allocations = game_allocation_count() - allocations_before;
+
+                double rate = ticks / elapsed;
+                if (t == 0) base_rate = rate;
+
+                printf("%8d %6d %8d %7d %14.0f %10.1f %7.2fx %8zu %10ld %9ld\n",
+                    object_counts[o], levels[l], config.capacity, threads,
+                    rate, elapsed * 1e9 / ticks, rate / base_rate,
+                    allocations, game_overs, level_ups);
+
+                // Last PROFILER_FRAMES ticks of the run, in microseconds
+                if (profiler_enabled) {
+                    for (int p = PROF_UPDATE_BALL; p <= PROF_UPDATE_SPAWN; p++) {
+                        double p50, p99;
+                        profiler_percentiles(p, &p50, &p99);
+                        printf("%24s p50 %8.2f us   p99 %8.2f us\n", profiler_phase_name(p), p50 * 1000.0, p99 * 1000.0);
+                    }
+                }
+
+                game_free(&game);
+                jobs_shutdown();
+            }
+        }
+    }
+
+    return 0;
+}
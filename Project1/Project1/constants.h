@@ -13,3 +13,22 @@
 #define FPS 60
 #define FRAME_TARGET_TIME (1000 / FPS)
 
+// Sprite sizes of assets/bag.png and assets/chickenidle2.png, for headless runs with no images
+// to measure (bench, the raster stand-ins) so they collide and draw like the real game
+#define BAG_WIDTH 78
+#define BAG_HEIGHT 73
+#define CHICKEN_WIDTH 82
+#define CHICKEN_HEIGHT 85
+
+// Fixed Timestep
+#define SIM_HZ 120          // Default simulation ticks per second, override with --hz
+#define MIN_SIM_HZ 30
+#define MAX_SIM_HZ 1000
+#define MAX_FRAME_TIME 0.25 // Seconds, longer frames are clamped so the sim can't fall into a catch-up spiral
+
+// Rewind (R): how far one press goes back, and how much history the sim thread keeps
+#define REWIND_SECONDS 3
+#define REWIND_HISTORY_SECONDS 60
+
+// Static screens (game over, pause) sleep in the event queue, this long at most between wakeups
+#define IDLE_WAIT_MS 500
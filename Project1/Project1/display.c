@@ -0,0 +1,205 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <math.h>
+
+// User_defined_library
+#include <SDL.h>
+
+// Other_includes
+#include "constants.h"
+#include "display.h"
+#include "text.h"
+
+// Offscreen scene, made for the full scale. A smaller scene only uses its top left corner.
+static SDL_Texture* target = NULL;
+static int target_width = 0, target_height = 0;
+static int targets_supported = FALSE;
+static int layout_dirty = TRUE;
+
+static SDL_Rect letterbox;      // Where the game goes in the window, in pixels
+static float scene_scale = DISPLAY_MAX_SCALE;
+static int scale_fixed = FALSE;
+static int scene_width = WINDOW_WIDTH, scene_height = WINDOW_HEIGHT;
+
+// Frame times since the last scale change
+static double frame_ms_sum = 0.0;
+static int frame_count = 0;
+static int frames_missed = 0;
+
+static int update_layout(SDL_Renderer* renderer) {
+    int output_width, output_height;
+    if (SDL_GetRendererOutputSize(renderer, &output_width, &output_height) != 0) {
+        printf("SDL_GetRendererOutputSize: %s\n", SDL_GetError());
+        return FALSE;
+    }
+
+    // Biggest rect with the game's shape, centered, the rest stays black
+    letterbox.w = output_width;
+    letterbox.h = output_width * WINDOW_HEIGHT / WINDOW_WIDTH;
+    if (letterbox.h > output_height) {
+        letterbox.h = output_height;
+        letterbox.w = output_height * WINDOW_WIDTH / WINDOW_HEIGHT;
+    }
+    if (letterbox.w < 1) letterbox.w = 1;
+    if (letterbox.h < 1) letterbox.h = 1;
+    letterbox.x = (output_width - letterbox.w) / 2;
+    letterbox.y = (output_height - letterbox.h) / 2;
+
+    if (targets_supported && (!target || target_width != letterbox.w || target_height != letterbox.h)) {
+        if (target) SDL_DestroyTexture(target);
+        target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, letterbox.w, letterbox.h);
+        if (target) {
+            SDL_SetTextureScaleMode(target, SDL_ScaleModeLinear);
+            target_width = letterbox.w;
+            target_height = letterbox.h;
+        }
+        else {
+            // Too big for the GPU most likely, draw straight into the window from now on
+            printf("Display: no offscreen target (%s), dynamic resolution is off\n", SDL_GetError());
+            targets_supported = FALSE;
+        }
+    }
+
+    // HUD text is rasterized for the real pixel size
+    text_set_scale((float)letterbox.w / WINDOW_WIDTH);
+
+    layout_dirty = FALSE;
+    return TRUE;
+}
+
+// Game units over the letterbox of the window
+static void set_hud(SDL_Renderer* renderer) {
+    float ui_scale = (float)letterbox.w / WINDOW_WIDTH;
+    SDL_RenderSetScale(renderer, ui_scale, ui_scale);
+
+    // The viewport is in scaled units too
+    SDL_Rect area = { (int)(letterbox.x / ui_scale), (int)(letterbox.y / ui_scale), WINDOW_WIDTH, WINDOW_HEIGHT };
+    SDL_RenderSetViewport(renderer, &area);
+}
+
+int display_init(SDL_Renderer* renderer, float fixed_scale) {
+    targets_supported = SDL_RenderTargetSupported(renderer);
+    if (!targets_supported) {
+        printf("Display: the renderer has no render targets, dynamic resolution is off\n");
+    }
+
+    if (fixed_scale > 0.0f) {
+        if (fixed_scale < DISPLAY_MIN_SCALE) fixed_scale = DISPLAY_MIN_SCALE;
+        if (fixed_scale > DISPLAY_MAX_SCALE) fixed_scale = DISPLAY_MAX_SCALE;
+        scene_scale = fixed_scale;
+        scale_fixed = TRUE;
+    }
+
+    layout_dirty = TRUE;
+    return update_layout(renderer);
+}
+
+void display_shutdown() {
+    if (target) SDL_DestroyTexture(target);
+    target = NULL;
+    target_width = target_height = 0;
+}
+
+void display_reset() {
+    layout_dirty = TRUE;
+}
+
+void display_begin_scene(SDL_Renderer* renderer) {
+    if (layout_dirty) update_layout(renderer);
+
+    if (!target) {
+        display_begin_hud(renderer);
+        return;
+    }
+
+    scene_width = (int)(letterbox.w * scene_scale + 0.5f);
+    scene_height = (int)(letterbox.h * scene_scale + 0.5f);
+    if (scene_width < 1) scene_width = 1;
+    if (scene_height < 1) scene_height = 1;
+
+    // Switching targets resets the scale and viewport, so they're set after. The target is
+    // letterbox sized and only the top left scene_width x scene_height gets drawn, so it's
+    // cleared first or linear scaling picks up a bigger scale's leftovers at the edges.
+    SDL_SetRenderTarget(renderer, target);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderSetScale(renderer, (float)scene_width / WINDOW_WIDTH, (float)scene_height / WINDOW_HEIGHT);
+    SDL_Rect area = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
+    SDL_RenderSetViewport(renderer, &area);
+}
+
+void display_end_scene(SDL_Renderer* renderer) {
+    // Without a target the scene is already in the window
+    if (!target) {
+        return;
+    }
+
+    SDL_SetRenderTarget(renderer, NULL);
+    SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+    SDL_RenderSetViewport(renderer, NULL);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+
+    SDL_Rect src = { 0, 0, scene_width, scene_height };
+    SDL_RenderCopy(renderer, target, &src, &letterbox);
+
+    set_hud(renderer);
+}
+
+void display_begin_hud(SDL_Renderer* renderer) {
+    if (layout_dirty) update_layout(renderer);
+
+    SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+    SDL_RenderSetViewport(renderer, NULL);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+
+    set_hud(renderer);
+}
+
+void display_frame_time(double ms, double budget_ms, int missed) {
+    if (scale_fixed || !target) {
+        return;
+    }
+
+    frame_ms_sum += ms;
+    frames_missed += missed;
+    if (++frame_count < DISPLAY_ADJUST_FRAMES) {
+        return;
+    }
+    double average = frame_ms_sum / frame_count;
+    int late = frames_missed;
+    frame_ms_sum = 0.0;
+    frame_count = 0;
+    frames_missed = 0;
+
+    // Drop early and climb late, so one step up doesn't push it straight back over
+    float scale = scene_scale;
+    if (average > budget_ms * 0.9) {
+        // Fill cost goes with the pixels, the square of the scale, aim for 75% of the budget
+        scale *= (float)sqrt(budget_ms * 0.75 / average);
+        scale = floorf(scale / DISPLAY_SCALE_STEP + 0.001f) * DISPLAY_SCALE_STEP;
+    }
+    else if (late > DISPLAY_MAX_MISSED) {
+        // With vsync the GPU time hides in the present, missed refreshes are what shows it
+        scale -= DISPLAY_SCALE_STEP;
+    }
+    else if (average < budget_ms * 0.5 && late == 0) {
+        scale += DISPLAY_SCALE_STEP;
+    }
+
+    if (scale < DISPLAY_MIN_SCALE) scale = DISPLAY_MIN_SCALE;
+    if (scale > DISPLAY_MAX_SCALE) scale = DISPLAY_MAX_SCALE;
+    scene_scale = scale;
+}
+
+float display_scale() {
+    return scene_scale;
+}
+
+void display_scene_size(int* width, int* height) {
+    if (width) *width = target ? scene_width : letterbox.w;
+    if (height) *height = target ? scene_height : letterbox.h;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SDL.h>
+
+// Dynamic resolution. The game draws in WINDOW_WIDTH x WINDOW_HEIGHT units as before, the scene
+// goes into an offscreen target at scene scale times the window's pixel size and is stretched
+// over the window, letterboxed to keep its shape. The scale follows the measured frame time:
+// it drops when frames run over budget and creeps back up when there's room, so a weak GPU
+// keeps its frame rate and a strong one gets the full high-DPI size. The HUD is drawn after
+// that straight into the window, text is rasterized at the window's pixel size.
+
+// Bounds for the scene scale, 1 is one scene pixel per window pixel
+#define DISPLAY_MIN_SCALE 0.25f
+#define DISPLAY_MAX_SCALE 1.0f
+#define DISPLAY_SCALE_STEP 0.05f
+
+// Frames averaged between two scale changes, and the missed deadlines among them that still count as keeping up
+#define DISPLAY_ADJUST_FRAMES 30
+#define DISPLAY_MAX_MISSED 1
+
+// Returns FALSE on failure. Without render target support the scene is drawn straight into the
+// window and the scale stays at 1. fixed_scale > 0 pins the scale instead of adapting it.
+int display_init(SDL_Renderer* renderer, float fixed_scale);
+void display_shutdown();
+
+// The window was resized or the render targets were lost, picked up by the next frame
+void display_reset();
+
+// Scene drawing goes to the offscreen target between these two. display_end_scene() copies it
+// to the window and leaves the renderer set up for the HUD, in game units.
+void display_begin_scene(SDL_Renderer* renderer);
+void display_end_scene(SDL_Renderer* renderer);
+
+// Clears the window and sets it up for the HUD, for screens without a scene (loading)
+void display_begin_hud(SDL_Renderer* renderer);
+
+// How long the last frame took to draw and present (leave out a vsync wait), the frame budget,
+// and whether it missed its deadline, all from the frame pacer
+void display_frame_time(double ms, double budget_ms, int missed);
+
+// Current scene scale and the size of the scene in pixels
+float display_scale();
+void display_scene_size(int* width, int* height);
@@ -0,0 +1,242 @@
+// Built_in_library
+#include <string.h>
+#include <stdlib.h>
+
+// Other_includes
+#include "eggs.h"
+
+// Pick the widest kernel the compiler targets, define EGGS_NO_SIMD to force the C version
+#if !defined(EGGS_NO_SIMD) && defined(__AVX__)
+#define EGGS_AVX
+#include <immintrin.h>
+#elif !defined(EGGS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define EGGS_SSE2
+#include <emmintrin.h>
+#endif
+
+// Each array starts on a 64 byte boundary inside the block
+#define ARRAY_ALIGN 64
+
+static size_t array_bytes(size_t element_size, int capacity) {
+    size_t bytes = element_size * (size_t)capacity;
+    return (bytes + ARRAY_ALIGN - 1) & ~(size_t)(ARRAY_ALIGN - 1);
+}
+
+size_t eggs_memory_size(int capacity) {
+    return array_bytes(sizeof(float), capacity) * 8 +
+        array_bytes(sizeof(int), capacity) * 4 +
+        array_bytes(sizeof(unsigned char), capacity) * 2 +
+        ARRAY_ALIGN;
+}
+
+void eggs_attach(Eggs* eggs, void* memory, int capacity) {
+    unsigned char* p = memory;
+    p += (ARRAY_ALIGN - ((size_t)p & (ARRAY_ALIGN - 1))) & (ARRAY_ALIGN - 1);
+
+    memset(eggs, 0, sizeof(*eggs));
+    eggs->capacity = capacity;
+
+    size_t floats = array_bytes(sizeof(float), capacity);
+    eggs->x = (float*)p; p += floats;
+    eggs->y = (float*)p; p += floats;
+    eggs->prev_x = (float*)p; p += floats;
+    eggs->prev_y = (float*)p; p += floats;
+    eggs->speedY = (float*)p; p += floats;
+    eggs->gravity = (float*)p; p += floats;
+    eggs->width = (float*)p; p += floats;
+    eggs->height = (float*)p; p += floats;
+    eggs->hits = (int*)p; p += array_bytes(sizeof(int), capacity);
+    eggs->ids = (int*)p; p += array_bytes(sizeof(int), capacity);
+    eggs->index_of = (int*)p; p += array_bytes(sizeof(int), capacity);
+    eggs->free_ids = (int*)p; p += array_bytes(sizeof(int), capacity);
+    eggs->hit_flags = p; p += array_bytes(sizeof(unsigned char), capacity);
+    eggs->hit_mark = p;
+
+    // Lowest ids come off the stack first
+    for (int id = 0; id < capacity; id++) {
+        eggs->index_of[id] = -1;
+        eggs->free_ids[id] = capacity - 1 - id;
+    }
+    eggs->num_free = capacity;
+}
+
+int eggs_add(Eggs* eggs) {
+    if (eggs->count >= eggs->capacity || eggs->num_free == 0) {
+        return -1;
+    }
+
+    int i = eggs->count++;
+    int id = eggs->free_ids[--eggs->num_free];
+    eggs->ids[i] = id;
+    eggs->index_of[id] = i;
+    return i;
+}
+
+void eggs_remove(Eggs* eggs, int i) {
+    int last = --eggs->count;
+
+    eggs->free_ids[eggs->num_free++] = eggs->ids[i];
+    eggs->index_of[eggs->ids[i]] = -1;
+    if (i == last) return;
+
+    eggs->ids[i] = eggs->ids[last];
+    eggs->index_of[eggs->ids[i]] = i;
+
+    eggs->x[i] = eggs->x[last];
+    eggs->y[i] = eggs->y[last];
+    eggs->prev_x[i] = eggs->prev_x[last];
+    eggs->prev_y[i] = eggs->prev_y[last];
+    eggs->speedY[i] = eggs->speedY[last];
+    eggs->gravity[i] = eggs->gravity[last];
+    eggs->width[i] = eggs->width[last];
+    eggs->height[i] = eggs->height[last];
+}
+
+void eggs_clear(Eggs* eggs) {
+    // Give the ids back newest first, so a refill hands them out in the same order as a fresh pool
+    for (int i = 0; i < eggs->count; i++) {
+        eggs->index_of[eggs->ids[i]] = -1;
+    }
+    while (eggs->count > 0) {
+        eggs->free_ids[eggs->num_free++] = eggs->ids[--eggs->count];
+    }
+}
+
+int eggs_index(const Eggs* eggs, int id) {
+    if (id < 0 || id >= eggs->capacity) {
+        return -1;
+    }
+    return eggs->index_of[id];
+}
+
+void eggs_snap(Eggs* eggs, int i) {
+    eggs->prev_x[i] = eggs->x[i];
+    eggs->prev_y[i] = eggs->y[i];
+}
+
+void eggs_store_previous(Eggs* eggs) {
+    memcpy(eggs->prev_x, eggs->x, sizeof(float) * eggs->count);
+    memcpy(eggs->prev_y, eggs->y, sizeof(float) * eggs->count);
+}
+
+void eggs_clear_hits(Eggs* eggs) {
+    for (int h = 0; h < eggs->num_hits; h++) {
+        eggs->hit_mark[eggs->hits[h]] = 0;
+    }
+    eggs->num_hits = 0;
+}
+
+void eggs_add_hit(Eggs* eggs, int i, unsigned char flag) {
+    if (!eggs->hit_mark[i]) {
+        eggs->hits[eggs->num_hits++] = i;
+    }
+    eggs->hit_mark[i] |= flag;
+}
+
+static int compare_index(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+void eggs_sort_hits(Eggs* eggs) {
+    qsort(eggs->hits, eggs->num_hits, sizeof(int), compare_index);
+    for (int h = 0; h < eggs->num_hits; h++) {
+        eggs->hit_flags[h] = eggs->hit_mark[eggs->hits[h]];
+    }
+}
+
+static float integrate_scalar(Eggs* eggs, float scale, int begin, int end, float max_step) {
+    for (int i = begin; i < end; i++) {
+        eggs->speedY[i] += eggs->gravity[i] * scale;
+        float step = eggs->speedY[i] * scale;
+        eggs->y[i] += step;
+        if (step > max_step) max_step = step;
+    }
+    return max_step;
+}
+
+#if defined(EGGS_AVX)
+
+static int integrate_vector(Eggs* eggs, float scale, int begin, int end, float* max_step) {
+    const __m256 s = _mm256_set1_ps(scale);
+    __m256 max = _mm256_set1_ps(*max_step);
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 speed = _mm256_loadu_ps(eggs->speedY + i);
+        __m256 y = _mm256_loadu_ps(eggs->y + i);
+        speed = _mm256_add_ps(speed, _mm256_mul_ps(_mm256_loadu_ps(eggs->gravity + i), s));
+        __m256 step = _mm256_mul_ps(speed, s);
+        y = _mm256_add_ps(y, step);
+        max = _mm256_max_ps(max, step);
+        _mm256_storeu_ps(eggs->speedY + i, speed);
+        _mm256_storeu_ps(eggs->y + i, y);
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, max);
+    for (int k = 0; k < 8; k++) {
+        if (lanes[k] > *max_step) *max_step = lanes[k];
+    }
+    return i;
+}
+
+const char* eggs_kernel_name() {
+    return "avx";
+}
+
+#elif defined(EGGS_SSE2)
+
+static int integrate_vector(Eggs* eggs, float scale, int begin, int end, float* max_step) {
+    const __m128 s = _mm_set1_ps(scale);
+    __m128 max = _mm_set1_ps(*max_step);
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 speed = _mm_loadu_ps(eggs->speedY + i);
+        __m128 y = _mm_loadu_ps(eggs->y + i);
+        speed = _mm_add_ps(speed, _mm_mul_ps(_mm_loadu_ps(eggs->gravity + i), s));
+        __m128 step = _mm_mul_ps(speed, s);
+        y = _mm_add_ps(y, step);
+        max = _mm_max_ps(max, step);
+        _mm_storeu_ps(eggs->speedY + i, speed);
+        _mm_storeu_ps(eggs->y + i, y);
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, max);
+    for (int k = 0; k < 4; k++) {
+        if (lanes[k] > *max_step) *max_step = lanes[k];
+    }
+    return i;
+}
+
+const char* eggs_kernel_name() {
+    return "sse2";
+}
+
+#else
+
+static int integrate_vector(Eggs* eggs, float scale, int begin, int end, float* max_step) {
+    (void)eggs;
+    (void)scale;
+    (void)end;
+    (void)max_step;
+    return begin;
+}
+
+const char* eggs_kernel_name() {
+    return "scalar";
+}
+
+#endif
+
+float eggs_integrate(Eggs* eggs, float scale) {
+    return eggs_integrate_range(eggs, scale, 0, eggs->count);
+}
+
+float eggs_integrate_range(Eggs* eggs, float scale, int begin, int end) {
+    // Whole vectors first, then the leftover eggs one by one
+    float max_step = 0.0f;
+    int done = integrate_vector(eggs, scale, begin, end, &max_step);
+    return integrate_scalar(eggs, scale, done, end, max_step);
+}
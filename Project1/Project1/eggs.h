@@ -0,0 +1,65 @@
+#pragma once
+
+// Egg pool stored as a structure of arrays, with the active eggs packed at the front.
+// Every egg also has an id that stays the same while it's alive, even when removing
+// another egg moves it to a different index. Freed ids go on a free list, so adding
+// and removing an egg are both O(1) whatever the capacity.
+// eggs_integrate() moves every egg with SSE2 / AVX when the compiler targets them,
+// and plain C otherwise. Collision queries go through the grid (grid.h).
+
+#include <stddef.h>
+
+// Hit flags
+#define EGG_HIT_BALL   0x01
+#define EGG_HIT_BLOCK  0x02
+#define EGG_HIT_GROUND 0x04
+
+typedef struct {
+    int capacity;
+    int count;          // Active eggs are [0, count)
+
+    float* x;
+    float* y;
+    float* prev_x;      // Position at the previous sim tick, used for interpolation
+    float* prev_y;
+    float* speedY;      // Vertical speed
+    float* gravity;
+    float* width;
+    float* height;
+
+    // Ids: ids[i] is the id of the egg at index i, index_of[id] is -1 while the id is free
+    int* ids;
+    int* index_of;
+    int* free_ids;      // Stack of ids not in use
+    int num_free;
+
+    // Eggs that hit something this tick, see eggs_add_hit()
+    int* hits;
+    unsigned char* hit_flags;
+    int num_hits;
+    unsigned char* hit_mark;    // Per egg flags while hits are being collected
+} Eggs;
+
+// Bytes needed for eggs_attach(), so the caller owns the single allocation
+size_t eggs_memory_size(int capacity);
+void eggs_attach(Eggs* eggs, void* memory, int capacity);
+
+int eggs_add(Eggs* eggs);               // Returns the new egg's index, or -1 when full
+void eggs_remove(Eggs* eggs, int i);    // Moves the last egg into slot i
+void eggs_clear(Eggs* eggs);            // Removes every egg, O(count)
+int eggs_index(const Eggs* eggs, int id); // Current index of a live egg, -1 if the id is free
+// scale is the tick length in 60 Hz frames, returns the furthest any egg fell this tick
+float eggs_integrate(Eggs* eggs, float scale);
+float eggs_integrate_range(Eggs* eggs, float scale, int begin, int end); // Eggs [begin, end) only, for the job system
+
+// Collecting hits: add them in any order, an egg hit twice gets its flags merged.
+// eggs_sort_hits() puts them in ascending index order and fills hit_flags.
+void eggs_clear_hits(Eggs* eggs);
+void eggs_add_hit(Eggs* eggs, int i, unsigned char flag);
+void eggs_sort_hits(Eggs* eggs);
+
+void eggs_snap(Eggs* eggs, int i);      // prev = current, for eggs that teleport
+void eggs_store_previous(Eggs* eggs);
+
+// "avx", "sse2" or "scalar"
+const char* eggs_kernel_name();
@@ -0,0 +1,159 @@
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Other_includes
+#include "env.h"
+#include "jobs.h"
+
+// Each game's egg pool starts on its own cache line
+#define ENV_ALIGN 64
+
+static size_t align_up(size_t bytes) {
+    return (bytes + ENV_ALIGN - 1) & ~(size_t)(ENV_ALIGN - 1);
+}
+
+int env_create(Env* env, int num_envs, const GameConfig* config, int sim_hz) {
+    memset(env, 0, sizeof(*env));
+    if (num_envs < 1 || sim_hz < 1) {
+        return FALSE;
+    }
+
+    // The envs are already spread over the threads, and nobody reads the console
+    GameConfig env_config = *config;
+    env_config.serial = 1;
+    env_config.quiet = 1;
+
+    size_t games_bytes = align_up(sizeof(Game) * num_envs);
+    size_t pool_bytes = align_up(game_memory_size(&env_config));
+    env->memory = malloc(games_bytes + pool_bytes * num_envs + ENV_ALIGN);
+    if (!env->memory) {
+        fprintf(stderr, "Error: Could not allocate %d envs\n", num_envs);
+        return FALSE;
+    }
+
+    char* base = env->memory;
+    base += (ENV_ALIGN - ((size_t)base & (ENV_ALIGN - 1))) & (ENV_ALIGN - 1);
+    env->games = (Game*)base;
+    for (int i = 0; i < num_envs; i++) {
+        game_attach(&env->games[i], &env_config, base + games_bytes + pool_bytes * i);
+    }
+
+    env->num_envs = num_envs;
+    env->delta_time = 1.0f / sim_hz;
+    return TRUE;
+}
+
+void env_destroy(Env* env) {
+    free(env->memory);
+    memset(env, 0, sizeof(*env));
+}
+
+void env_bind(Env* env, float* observations, float* rewards, unsigned char* dones) {
+    env->observations = observations;
+    env->rewards = rewards;
+    env->dones = dones;
+}
+
+// Keeps the ENV_OBS_MAX_EGGS lowest eggs, sorted lowest first
+static void observe_game(const Game* game, float* out) {
+    const Eggs* eggs = &game->eggs;
+
+    out[ENV_OBS_BALL_X] = game->ball.x;
+    out[ENV_OBS_BALL_Y] = game->ball.y;
+    out[ENV_OBS_BALL_VX] = game->ball.vx;
+    out[ENV_OBS_BALL_VY] = game->ball.vy;
+    out[ENV_OBS_BLOCK_X] = game->block.x;
+    out[ENV_OBS_BLOCK_Y] = game->block.y;
+    out[ENV_OBS_LEVEL] = (float)game->current_level;
+    out[ENV_OBS_COLLECTED] = (float)game->collected_objects;
+    out[ENV_OBS_TO_COLLECT] = (float)game->to_collect;
+    out[ENV_OBS_EGG_COUNT] = (float)eggs->count;
+
+    int lowest[ENV_OBS_MAX_EGGS];
+    int found = 0;
+    for (int i = 0; i < eggs->count; i++) {
+        float y = eggs->y[i];
+        if (found == ENV_OBS_MAX_EGGS && y <= eggs->y[lowest[found - 1]]) {
+            continue;
+        }
+
+        int k = found < ENV_OBS_MAX_EGGS ? found++ : found - 1;
+        while (k > 0 && eggs->y[lowest[k - 1]] < y) {
+            lowest[k] = lowest[k - 1];
+            k--;
+        }
+        lowest[k] = i;
+    }
+
+    float* egg_out = out + ENV_OBS_EGGS;
+    for (int k = 0; k < ENV_OBS_MAX_EGGS; k++) {
+        int i = lowest[k];
+        egg_out[k * 3 + 0] = k < found ? eggs->x[i] : 0.0f;
+        egg_out[k * 3 + 1] = k < found ? eggs->y[i] : 0.0f;
+        egg_out[k * 3 + 2] = k < found ? eggs->speedY[i] : 0.0f;
+    }
+}
+
+void env_observe(const Env* env, float* observations) {
+    for (int i = 0; i < env->num_envs; i++) {
+        observe_game(&env->games[i], observations + (size_t)i * ENV_OBS_SIZE);
+    }
+}
+
+void env_reset(Env* env, unsigned int seed) {
+    for (int i = 0; i < env->num_envs; i++) {
+        Game* game = &env->games[i];
+        game->current_level = 1;
+        game_seed(game, seed + (unsigned int)i);
+        setup(game);
+        game_clear_events(game);
+    }
+
+    if (env->observations) {
+        env_observe(env, env->observations);
+    }
+    if (env->rewards) {
+        memset(env->rewards, 0, sizeof(float) * env->num_envs);
+    }
+    if (env->dones) {
+        memset(env->dones, 0, env->num_envs);
+    }
+}
+
+static void step_chunk(void* data, int chunk, int begin, int end) {
+    Env* env = data;
+    (void)chunk;
+
+    for (int i = begin; i < end; i++) {
+        Game* game = &env->games[i];
+
+        // Nothing draws the envs, so there's no previous state to keep for blending
+        game_clear_events(game);
+        update(game, env->actions[i], env->delta_time);
+
+        float reward = 0.0f;
+        for (int e = 0; e < game->num_events; e++) {
+            if (game->events[e].type == GAME_EVENT_CATCH) reward += 1.0f;
+        }
+
+        // Same rules as the game loop: a game over restarts from level 1, a level up carries on
+        int done = game->is_game_over;
+        if (done) {
+            reward -= 1.0f;
+            reset_game(game);
+        }
+        game->level_complete = 0;
+
+        if (env->observations) observe_game(game, env->observations + (size_t)i * ENV_OBS_SIZE);
+        if (env->rewards) env->rewards[i] = reward;
+        if (env->dones) env->dones[i] = (unsigned char)done;
+    }
+}
+
+void env_step(Env* env, const unsigned int* actions) {
+    env->actions = actions;
+    jobs_parallel_for(env->num_envs, ENV_GRAIN, step_chunk, env);
+    env->actions = NULL;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Headless environments for training bots: N independent games stepped together.
+// The Game structs sit in one array and all their egg pools in one block right after it,
+// env_step() runs them in chunks over the job system (jobs_init() first to use threads).
+// Each env only ever touches its own game, so results don't depend on the thread count.
+//
+// Observations, rewards and done flags are written straight into buffers the caller
+// binds with env_bind(), by the thread that just stepped that env, nothing is copied twice.
+// A game over is reported as done and the env starts a new game in the same step, so its
+// observation is already the first one of the next game.
+
+#include <stddef.h>
+
+#include "game.h"
+
+// Envs per job system chunk
+#define ENV_GRAIN 64
+
+// Eggs in an observation, the lowest ones on screen
+#define ENV_OBS_MAX_EGGS 8
+
+// Observation layout, ENV_OBS_SIZE floats per env
+enum {
+    ENV_OBS_BALL_X,
+    ENV_OBS_BALL_Y,
+    ENV_OBS_BALL_VX,
+    ENV_OBS_BALL_VY,        // Up is positive, like Ball.vy
+    ENV_OBS_BLOCK_X,
+    ENV_OBS_BLOCK_Y,
+    ENV_OBS_LEVEL,
+    ENV_OBS_COLLECTED,
+    ENV_OBS_TO_COLLECT,
+    ENV_OBS_EGG_COUNT,
+    ENV_OBS_EGGS,           // x, y, speed for each egg, lowest first, zeros past the egg count
+    ENV_OBS_SIZE = ENV_OBS_EGGS + ENV_OBS_MAX_EGGS * 3
+};
+
+typedef struct {
+    int num_envs;
+    float delta_time;       // One sim tick
+    Game* games;
+    void* memory;           // Backs the games and their egg pools
+
+    // Bound by the caller, any of them can be NULL
+    float* observations;    // ENV_OBS_SIZE per env
+    float* rewards;         // Eggs caught in the step, minus 1 for a game over
+    unsigned char* dones;   // Game over, the env already started a new game
+
+    const unsigned int* actions; // Only during env_step()
+} Env;
+
+// config is shared by every env, sim_hz sets the tick length. Returns FALSE on failure.
+int env_create(Env* env, int num_envs, const GameConfig* config, int sim_hz);
+void env_destroy(Env* env);
+
+void env_bind(Env* env, float* observations, float* rewards, unsigned char* dones);
+
+// Starts every env at level 1, env i seeded with seed + i, and writes the observations
+void env_reset(Env* env, unsigned int seed);
+
+// One tick for every env, actions holds one INPUT_* mask per env
+void env_step(Env* env, const unsigned int* actions);
+
+// Writes every env's observation, ENV_OBS_SIZE floats each
+void env_observe(const Env* env, float* observations);
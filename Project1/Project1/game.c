@@ -0,0 +1,839 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+
+// Other_includes
+#include "game.h"
+#include "jobs.h"
+#include "profiler.h"
+
+// Allocation counters
+static size_t allocation_count = 0;
+static size_t allocated_bytes = 0;
+
+static void* game_alloc(size_t size) {
+    allocation_count++;
+    allocated_bytes += size;
+    return calloc(1, size);
+}
+
+size_t game_allocation_count() {
+    return allocation_count;
+}
+
+size_t game_allocated_bytes() {
+    return allocated_bytes;
+}
+
+void game_seed(Game* game, unsigned int seed) {
+    rng_seed(&game->spawn_rng, seed, RNG_STREAM_SPAWN);
+}
+
+void game_default_config(GameConfig* config) {
+    config->capacity = NUM_OBJECTS;
+    config->egg_count = 0;
+    config->quiet = 0;
+    config->serial = 0;
+    config->ball_width = 15;
+    config->ball_height = 15;
+    config->block_width = 90;
+    config->block_height = 40;
+}
+
+static int config_capacity(const GameConfig* config) {
+    return config->capacity < 1 ? 1 : config->capacity;
+}
+
+size_t game_memory_size(const GameConfig* config) {
+    int capacity = config_capacity(config);
+    return eggs_memory_size(capacity) +
+        grid_memory_size(capacity, WINDOW_WIDTH, WINDOW_HEIGHT, GRID_CELL_SIZE) +
+        sizeof(EggChunk) * jobs_chunk_count(capacity, PARALLEL_GRAIN);
+}
+
+void game_attach(Game* game, const GameConfig* config, void* memory) {
+    memset(game, 0, sizeof(*game));
+    game->config = *config;
+    game->config.capacity = config_capacity(config);
+    game->current_level = 1;
+
+    int capacity = game->config.capacity;
+    game->total_objects_to_collect = capacity;
+
+    size_t egg_bytes = eggs_memory_size(capacity);
+    size_t grid_bytes = grid_memory_size(capacity, WINDOW_WIDTH, WINDOW_HEIGHT, GRID_CELL_SIZE);
+    eggs_attach(&game->eggs, memory, capacity);
+    grid_attach(&game->grid, (char*)memory + egg_bytes, capacity, WINDOW_WIDTH, WINDOW_HEIGHT, GRID_CELL_SIZE);
+    game->chunks = (EggChunk*)((char*)memory + egg_bytes + grid_bytes);
+}
+
+int game_init(Game* game, const GameConfig* config) {
+    void* memory = game_alloc(game_memory_size(config));
+    if (!memory) {
+        fprintf(stderr, "Error: Could not allocate %d objects\n", config_capacity(config));
+        memset(game, 0, sizeof(*game));
+        return FALSE;
+    }
+
+    game_attach(game, config, memory);
+    game->egg_memory = memory;
+    return TRUE;
+}
+
+void game_free(Game* game) {
+    free(game->egg_memory);
+    game->egg_memory = NULL;
+    memset(&game->eggs, 0, sizeof(game->eggs));
+    memset(&game->grid, 0, sizeof(game->grid));
+    game->chunks = NULL;
+}
+
+// Drops every egg, the level code refills them
+static void clear_eggs(Game* game) {
+    eggs_clear(&game->eggs);
+    grid_clear(&game->grid, game->config.capacity);
+}
+
+static void add_event(Game* game, int type, float x, float y) {
+    if (game->num_events == GAME_MAX_EVENTS) return;
+
+    GameEvent* event = &game->events[game->num_events++];
+    event->type = type;
+    event->x = x;
+    event->y = y;
+}
+
+void game_clear_events(Game* game) {
+    game->num_events = 0;
+}
+
+int game_egg_count(const GameConfig* config, int level) {
+    long long count = level == 1 ? INITIAL_OBJECTS : INITIAL_OBJECTS + (level * 2);
+
+    // The override is level 1's count, later levels grow by the same factor
+    if (config->egg_count > 0) {
+        count = count * config->egg_count / INITIAL_OBJECTS;
+    }
+    return count > INT_MAX ? INT_MAX : (int)count;
+}
+
+// Eggs falling at once on the current level, never past the pool whatever the level or the override
+static int level_egg_count(const Game* game) {
+    int count = game_egg_count(&game->config, game->current_level);
+    if (count > game->config.capacity) count = game->config.capacity;
+    if (count < 0) count = 0;
+    return count;
+}
+
+// Takes up to count eggs from the pool above the screen, returns how many it got.
+// New eggs are always the last ones, so their positions and gravity come in one batch each.
+static int spawn_eggs(Game* game, int count) {
+    Eggs* eggs = &game->eggs;
+    int first = eggs->count;
+    while (eggs->count - first < count && eggs_add(eggs) >= 0) {}
+    int spawned = eggs->count - first;
+
+    rng_fill_int(&game->spawn_rng, eggs->x + first, spawned, 0, WINDOW_WIDTH - EGG_SIZE);
+    rng_fill_int(&game->spawn_rng, eggs->gravity + first, spawned, 1, 6);
+
+    for (int i = first; i < eggs->count; i++) {
+        eggs->y[i] = -100.0f - (i * 50); // Stagger the starting heights
+        eggs->speedY[i] = 0;
+        eggs->gravity[i] /= 50.0f;
+        eggs->width[i] = EGG_SIZE;
+        eggs->height[i] = EGG_SIZE;
+        eggs_snap(eggs, i);
+    }
+    return spawned;
+}
+
+// Removes egg i and keeps the grid in step with the egg that moves into its slot
+static void remove_egg(Game* game, int i) {
+    grid_remove(&game->grid, &game->eggs, i);
+    eggs_remove(&game->eggs, i);
+}
+
+// Where the bag, the chicken and the ground were when the tick started, and how far they moved
+typedef struct {
+    FRect ball, block, ground;
+    float ball_dx, ball_dy;
+    float block_dx, block_dy;
+    float frame_scale;
+} TickMotion;
+
+// Sweeps egg i over the tick against the targets in which, returns the EGG_HIT_* flags it got
+static unsigned char sweep_egg(const Eggs* eggs, int i, const TickMotion* motion, unsigned char which) {
+    // Eggs only fall, and eggs_integrate() moved this one down by exactly step
+    float step = eggs->speedY[i] * motion->frame_scale;
+    FRect egg = { eggs->x[i], eggs->y[i] - step, eggs->width[i], eggs->height[i] };
+    SweepHit hit;
+
+    unsigned char flags = 0;
+    if ((which & EGG_HIT_BALL) && sweep_collision(egg, motion->ball, -motion->ball_dx, step - motion->ball_dy, &hit)) {
+        flags |= EGG_HIT_BALL;
+    }
+    if ((which & EGG_HIT_BLOCK) && sweep_collision(egg, motion->block, -motion->block_dx, step - motion->block_dy, &hit)) {
+        flags |= EGG_HIT_BLOCK;
+    }
+    if ((which & EGG_HIT_GROUND) && sweep_collision(egg, motion->ground, 0.0f, step, &hit)) {
+        flags |= EGG_HIT_GROUND;
+    }
+    return flags;
+}
+
+// Everything a target swept over this tick, stretched down by the furthest an egg fell.
+// An egg that touched the target at any point of the tick ends up overlapping it.
+static FRect swept_area(FRect start, float dx, float dy, float max_step) {
+    float x0 = dx < 0 ? start.x + dx : start.x;
+    float y0 = dy < 0 ? start.y + dy : start.y;
+    FRect area = { x0 - 1.0f, y0 - 1.0f, start.w + (dx < 0 ? -dx : dx) + 2.0f, start.h + (dy < 0 ? -dy : dy) + max_step + 2.0f };
+    return area;
+}
+
+// Adds the eggs in area that swept into the target to the tick's hit list
+static void collect_hits(Game* game, FRect area, const TickMotion* motion, unsigned char flag) {
+    Eggs* eggs = &game->eggs;
+    int* found = eggs->hits + eggs->num_hits;  // Unused tail of the hit list as scratch
+    int max = eggs->capacity - eggs->num_hits;
+
+    int n = grid_query(&game->grid, eggs, area, found, max);
+
+    // eggs_add_hit() appends at most one entry per result, so it never overwrites a result not read yet
+    for (int k = 0; k < n; k++) {
+        if (sweep_egg(eggs, found[k], motion, flag)) {
+            eggs_add_hit(eggs, found[k], flag);
+        }
+    }
+}
+
+// Hits for the tick through the grid, sorted by index, and how many were caught / hit the chicken
+static void find_hits(Game* game, const TickMotion* motion, float max_step, int* caught, int* block_hits) {
+    Eggs* eggs = &game->eggs;
+
+    collect_hits(game, swept_area(motion->ball, motion->ball_dx, motion->ball_dy, max_step), motion, EGG_HIT_BALL);
+    collect_hits(game, swept_area(motion->block, motion->block_dx, motion->block_dy, max_step), motion, EGG_HIT_BLOCK);
+    collect_hits(game, swept_area(motion->ground, 0.0f, 0.0f, max_step), motion, EGG_HIT_GROUND);
+    eggs_sort_hits(eggs);
+
+    for (int h = 0; h < eggs->num_hits; h++) {
+        int flags = eggs->hit_flags[h];
+        if (flags & EGG_HIT_BALL) (*caught)++;
+        else if (flags & EGG_HIT_BLOCK) (*block_hits)++;
+    }
+}
+
+// Shared by the chunks of the parallel integrate pass
+typedef struct {
+    Game* game;
+    TickMotion motion;
+} EggPass;
+
+// A chunk only writes its own eggs and its own EggChunk, so the chunks never touch the same memory
+static void integrate_chunk(void* data, int chunk, int begin, int end) {
+    EggPass* pass = data;
+    pass->game->chunks[chunk].max_step = eggs_integrate_range(&pass->game->eggs, pass->motion.frame_scale, begin, end);
+}
+
+// Same as eggs_integrate(), with the chunks spread over the job system
+static float integrate_parallel(Game* game, EggPass* pass) {
+    jobs_parallel_for(game->eggs.count, PARALLEL_GRAIN, integrate_chunk, pass);
+
+    float max_step = 0.0f;
+    int chunks = jobs_chunk_count(game->eggs.count, PARALLEL_GRAIN);
+    for (int c = 0; c < chunks; c++) {
+        if (game->chunks[c].max_step > max_step) max_step = game->chunks[c].max_step;
+    }
+    return max_step;
+}
+
+void setup(Game* game) {
+    Ball* ball = &game->ball;
+    Block* block = &game->block;
+    Floor* ground = &game->ground;
+
+    game->to_collect = 10 + (game->current_level - 1) * 2;
+
+    // Reset collected objects
+    game->is_game_over = 0;
+    game->collected_objects = 0;
+    game->level_complete = 0;
+
+    // Ball
+    ball->x = 500;
+    ball->y = 500;
+    ball->vx = 200;
+    ball->vy = 150;
+
+    // Block
+    block->vx = 200;
+    block->vy = 100;
+    anim_start(&game->chicken, ANIM_IDLE);
+    game->chicken_facing = -1;
+
+    // Ground
+    ground->width = WINDOW_WIDTH;
+    ground->height = 20; // Small height for ground
+    ground->x = 0;
+    ground->y = WINDOW_HEIGHT - ground->height; // Place at bottom of the screen
+
+    // Dimensions match the loaded textures
+    ball->width = game->config.ball_width;
+    ball->height = game->config.ball_height;
+    block->width = game->config.block_width;
+    block->height = game->config.block_height;
+
+    // Adjust block position to align with the ground
+    block->x = 400;
+    block->y = WINDOW_HEIGHT - block->height - ground->height; // Ensure it sits just above the ground
+
+    // Create the falling objects
+    game->total_objects_to_collect = level_egg_count(game);
+    clear_eggs(game);
+    spawn_eggs(game, game->total_objects_to_collect);
+
+    store_previous_state(game);
+}
+
+// Advances the game by one fixed tick of delta_time seconds
+void update(Game* game, unsigned int input, float delta_time) {
+    Ball* ball = &game->ball;
+    Block* block = &game->block;
+    Floor* ground = &game->ground;
+    Eggs* eggs = &game->eggs;
+
+    // Egg speed and gravity are tuned per 60 Hz frame, scale them to the tick length
+    float frame_scale = delta_time * FPS;
+
+    PROFILE_BEGIN(PROF_UPDATE_BALL);
+
+    // Where the bag and the chicken start the tick, collisions are swept from here
+    FRect ball_start = { ball->x, ball->y, ball->width, ball->height };
+    FRect block_start = { block->x, block->y, block->width, block->height };
+
+    // Ball / Bag Speed Multiplier
+    float ball_speed_multiplier = 1.0f;
+
+    if (input & INPUT_BOOST) {
+        ball_speed_multiplier = 3.0f; // Triple the speed when Space is held
+    }
+
+    // Update ball position using delta_time
+    ball->x += ball->vx * ball_speed_multiplier * delta_time;
+    ball->y -= ball->vy * ball_speed_multiplier * delta_time;
+
+    // Increase block speed by adjusting block.vx
+    block->vx = 400.0f;  // Make block move faster (adjust value as needed)
+
+    // Adjust player speed when Shift is pressed
+    float speed_multiplier = 1.0f; // Default speed
+    if (input & INPUT_FAST) {
+        speed_multiplier = 3.0f; // Triple the speed when Shift is held
+    }
+
+    // Continuous movement based on key state
+    if (input & INPUT_LEFT) {
+        block->x -= block->vx * speed_multiplier * delta_time;
+    }
+    if (input & INPUT_RIGHT) {
+        block->x += block->vx * speed_multiplier * delta_time;
+    }
+
+    // Chicken animation: psychic while Space is held, else running while it moves, else idle
+    int moving = (input & (INPUT_LEFT | INPUT_RIGHT)) == INPUT_LEFT || (input & (INPUT_LEFT | INPUT_RIGHT)) == INPUT_RIGHT;
+    if (moving) {
+        game->chicken_facing = (input & INPUT_LEFT) ? -1 : 1;
+    }
+    if (input & INPUT_BOOST) {
+        anim_play(&game->chicken, ANIM_PSYCHIC, 1.0f);
+    }
+    else if (moving) {
+        anim_play(&game->chicken, ANIM_RUN, (input & INPUT_FAST) ? 2.0f : 1.0f);
+    }
+    else {
+        anim_play(&game->chicken, ANIM_IDLE, 1.0f);
+    }
+    anim_advance(&game->chicken, delta_time);
+
+    // Ensure block / player stays within the window bounds
+    if (block->x < 0) {
+        block->x = 0;
+    }
+    if (block->x + block->width > WINDOW_WIDTH) {
+        block->x = WINDOW_WIDTH - block->width;
+    }
+
+    // Ball boundary checks
+    if (ball->x < 0 || ball->x + ball->width > WINDOW_WIDTH) {
+        ball->vx *= -1; // Reverse horizontal velocity
+        if (ball->x < 0) ball->x = 0;
+        if (ball->x + ball->width > WINDOW_WIDTH) ball->x = WINDOW_WIDTH - ball->width;
+        /*  Check if the ball's right edge (ball.x + ball.width) exceeds the window's width (WINDOW_WIDTH).
+            If it does, reposition the ball so its right edge aligns exactly with the window boundary.
+            This prevents the ball from moving outside the visible area of the screen.
+        */
+    }
+
+    if (ball->y < 0 || ball->y + ball->height > WINDOW_HEIGHT) {
+        ball->vy *= -1; // Reverse vertical velocity
+        if (ball->y < 0) ball->y = 0;
+        if (ball->y + ball->height > WINDOW_HEIGHT) ball->y = WINDOW_HEIGHT - ball->height;
+        /*  Check if the ball's top edge (ball.y) or bottom edge (ball.y + ball.height) exceeds the window's boundaries.
+            If the top edge goes above 0, reposition the ball so its top edge aligns with the top boundary.
+            If the bottom edge exceeds the window height (WINDOW_HEIGHT), reposition the ball so its bottom edge aligns with the bottom boundary.
+            This prevents the ball from moving outside the visible area of the screen.
+        */
+    }
+
+    // Block boundary checks
+    if (block->x < 0 || block->x + block->width > WINDOW_WIDTH) {
+        if (block->x < 0) block->x = 0;
+        if (block->x + block->width > WINDOW_WIDTH) block->x = WINDOW_WIDTH - block->width;
+    }
+
+    if (block->y < 0 || block->y + block->height > WINDOW_HEIGHT) {
+        if (block->y < 0) block->y = 0;
+        if (block->y + block->height > WINDOW_HEIGHT) block->y = WINDOW_HEIGHT - block->height;
+    }
+
+    // Sweep the bag against the chicken over the whole tick, so a fast bag can't pass through it
+    // between two ticks. The chicken moves too, so the sweep uses the bag's motion relative to it.
+    float rel_dx = (ball->x - ball_start.x) - (block->x - block_start.x);
+    float rel_dy = (ball->y - ball_start.y) - (block->y - block_start.y);
+    FRect ball_end = { ball->x, ball->y, ball->width, ball->height };
+    FRect block_end = { block->x, block->y, block->width, block->height };
+    SweepHit hit;
+
+    if (sweep_collision(ball_start, block_start, rel_dx, rel_dy, &hit)) {
+        // Bounce off the side it reached first and travel back for the rest of the tick. The
+        // velocity is pointed away from that side rather than flipped, a wall bounce earlier
+        // in the tick may have flipped it already.
+        if (hit.axis == SWEEP_X) {
+            ball->vx = rel_dx > 0 ? -fabsf(ball->vx) : fabsf(ball->vx);
+            float contact = rel_dx > 0 ? block->x - ball->width : block->x + block->width;
+            ball->x = contact - (1.0f - hit.time) * rel_dx;
+            if (ball->x < 0) ball->x = 0;
+            if (ball->x + ball->width > WINDOW_WIDTH) ball->x = WINDOW_WIDTH - ball->width;
+        }
+        else if (hit.axis == SWEEP_Y) {
+            ball->vy = rel_dy > 0 ? fabsf(ball->vy) : -fabsf(ball->vy); // vy is upwards
+            float contact = rel_dy > 0 ? block->y - ball->height : block->y + block->height;
+            ball->y = contact - (1.0f - hit.time) * rel_dy;
+        }
+        else if (check_collision(ball_end, block_end)) {
+            // They already overlapped when the tick started, determine the collision direction
+            float overlapLeft = (ball->x + ball->width) - block->x;
+            float overlapRight = (block->x + block->width) - ball->x;
+            float overlapTop = (ball->y + ball->height) - block->y;
+            float overlapBottom = (block->y + block->height) - ball->y;
+
+            // Find the smallest overlap to determine the side of the collision
+            float minOverlapX = (overlapLeft < overlapRight) ? overlapLeft : overlapRight;
+            float minOverlapY = (overlapTop < overlapBottom) ? overlapTop : overlapBottom;
+
+            if (minOverlapX < minOverlapY) {
+                // Horizontal collision
+                ball->vx *= -1; // Reverse horizontal velocity
+                if (overlapLeft < overlapRight) {
+                    ball->x = block->x - ball->width; // Reposition to the left of the block
+                }
+                else {
+                    ball->x = block->x + block->width; // Reposition to the right of the block
+                }
+            }
+            else {
+                // Vertical collision
+                ball->vy *= -1; // Reverse vertical velocity
+                if (overlapTop < overlapBottom) {
+                    ball->y = block->y - ball->height; // Reposition above the block
+                }
+                else {
+                    ball->y = block->y + block->height; // Reposition below the block
+                }
+            }
+        }
+    }
+
+    // Checked where the bag ended up, a bounce off the chicken keeps it clear of the ground
+    FRect ball_rect = { ball->x, ball->y, ball->width, ball->height };
+    FRect ground_rect = { ground->x, ground->y, ground->width, ground->height };
+    if (check_collision(ball_rect, ground_rect)) {
+        game->is_game_over = 1;
+        ball->y = ground->y - ball->height; // Align the ball above the ground
+    }
+
+    PROFILE_END(PROF_UPDATE_BALL);
+
+    // Eggs are swept against where the bag and the chicken went this tick. Eggs that fell
+    // through the ground are filed in the bottom row, so the ground area reaches down past the screen.
+    EggPass pass;
+    pass.game = game;
+    pass.motion.ball = ball_start;
+    pass.motion.block = block_start;
+    pass.motion.ground = (FRect){ ground->x, ground->y, ground->width, ground->height + WINDOW_HEIGHT };
+    pass.motion.ball_dx = ball->x - ball_start.x;
+    pass.motion.ball_dy = ball->y - ball_start.y;
+    pass.motion.block_dx = block->x - block_start.x;
+    pass.motion.block_dy = block->y - block_start.y;
+    pass.motion.frame_scale = frame_scale;
+
+    // Move every egg, big pools over the job system, then refile the ones that changed cell
+    PROFILE_BEGIN(PROF_UPDATE_EGGS);
+    float max_step;
+    if (!game->config.serial && jobs_thread_count() > 1 && eggs->count >= PARALLEL_MIN_EGGS) {
+        max_step = integrate_parallel(game, &pass);
+    }
+    else {
+        max_step = eggs_integrate(eggs, frame_scale);
+    }
+    grid_update(&game->grid, eggs);
+    PROFILE_END(PROF_UPDATE_EGGS);
+
+    PROFILE_BEGIN(PROF_UPDATE_COLLISION);
+
+    // Only the cells near the bag, the chicken and the ground are visited
+    int caught_count = 0;
+    int block_hits = 0;
+    find_hits(game, &pass.motion, max_step, &caught_count, &block_hits);
+
+    game->collected_objects += caught_count;
+    if (block_hits > 0) {  // Only end game for eggs that weren't caught
+        game->is_game_over = 1;
+        if (!game->config.quiet) printf("Game over due to block-object collision\n");
+    }
+
+    // Only the eggs that hit something need any work. Go from the last one so
+    // removing an egg (which moves the last egg into its slot) can't skip a hit.
+    for (int h = eggs->num_hits - 1; h >= 0; h--) {
+        int i = eggs->hits[h];
+        int flags = eggs->hit_flags[h];
+        int caught = flags & EGG_HIT_BALL;
+
+        // Effects go where the egg is now, before it gets reset or removed
+        float center_x = eggs->x[i] + eggs->width[i] * 0.5f;
+        if (caught) {
+            add_event(game, GAME_EVENT_CATCH, center_x, eggs->y[i] + eggs->height[i] * 0.5f);
+        }
+        else if (flags & EGG_HIT_GROUND) {
+            add_event(game, GAME_EVENT_SPLAT, center_x, ground->y);
+        }
+
+        // Reset object if it hits the ground
+        if (flags & EGG_HIT_GROUND) {
+            initializeObject(eggs, &game->spawn_rng, i);
+            eggs_snap(eggs, i);
+        }
+        else if (caught) {
+            remove_egg(game, i); // Make the object disappear
+        }
+    }
+    eggs_clear_hits(eggs);
+
+    PROFILE_END(PROF_UPDATE_COLLISION);
+
+    if (game->is_game_over) {
+        if (!game->config.quiet) printf("Game Over\n");
+        return;
+    }
+
+    if (game->collected_objects >= game->to_collect) {
+        game->is_game_over = 0;
+        game->current_level++;
+        game->level_complete = 1;
+        add_event(game, GAME_EVENT_LEVEL_UP, block->x + block->width * 0.5f, block->y + block->height * 0.5f);
+
+        // Increase difficulty
+        increase_level_difficulty(game);
+
+        // Reset game state for next level
+        setup(game);
+        if (!game->config.quiet) {
+            printf("Collected Objects: %d, Total Objects: %d\n", game->collected_objects, game->total_objects_to_collect);
+            printf("Level completed! Moving to Level %d\n", game->current_level);
+        }
+        return;
+    }
+
+    // Replace the eggs caught this tick, one pool pop each
+    PROFILE_BEGIN(PROF_UPDATE_SPAWN);
+    if (eggs->count < game->total_objects_to_collect) {
+        spawn_eggs(game, game->total_objects_to_collect - eggs->count);
+    }
+    PROFILE_END(PROF_UPDATE_SPAWN);
+}
+
+// Add a reset function to reinitialize game state
+void reset_game(Game* game) {
+    // Reset level and object collection
+    game->current_level = 1;
+    game->total_objects_to_collect = level_egg_count(game);
+    game->collected_objects = 0;
+    game->to_collect = 10;
+
+    // Reset ball position and velocity
+    game->ball.x = 500;
+    game->ball.y = 500;
+    game->ball.vx = 200;
+    game->ball.vy = 150;
+
+    // Reset block position
+    game->block.x = 400;
+    game->block.y = WINDOW_HEIGHT - game->block.height - game->ground.height;
+
+    // Reset objects
+    clear_eggs(game);
+    spawn_eggs(game, game->total_objects_to_collect);
+
+    // Reset game state flags
+    game->is_game_over = 0;
+    game->level_complete = 0;
+
+    store_previous_state(game);
+}
+
+// Speeds up the ball and the bag, setup() then refills the eggs for the new level
+void increase_level_difficulty(Game* game) {
+    game->total_objects_to_collect = level_egg_count(game);
+
+    // Reset collected objects
+    game->collected_objects = 0;
+
+    // Gradually increase speeds
+    game->ball.vx *= 1.1f;
+    game->ball.vy *= 1.1f;
+    game->block.vx *= 1.1f;
+
+    if (!game->config.quiet) {
+        printf("Level difficulty increased. New level: %d, Total objects: %d\n", game->current_level, game->total_objects_to_collect);
+    }
+}
+
+/* Functionalities */
+
+// Slab test on one axis: when a (at pos, size, moving by d) starts and stops overlapping [low, high)
+static bool sweep_axis(float pos, float size, float d, float low, float high, float* enter, float* exit) {
+    if (d == 0.0f) {
+        // Not moving on this axis, it overlaps the whole tick or never
+        *enter = -FLT_MAX;
+        *exit = FLT_MAX;
+        return pos + size > low && pos < high;
+    }
+
+    float t0 = (low - (pos + size)) / d;
+    float t1 = (high - pos) / d;
+    *enter = t0 < t1 ? t0 : t1;
+    *exit = t0 < t1 ? t1 : t0;
+    return true;
+}
+
+bool sweep_collision(FRect a, FRect b, float dx, float dy, SweepHit* hit) {
+    float enter_x, exit_x, enter_y, exit_y;
+    if (!sweep_axis(a.x, a.w, dx, b.x, b.x + b.w, &enter_x, &exit_x)) return false;
+    if (!sweep_axis(a.y, a.h, dy, b.y, b.y + b.h, &enter_y, &exit_y)) return false;
+
+    // Overlapping on both axes at once, some time during the tick
+    float enter = enter_x > enter_y ? enter_x : enter_y;
+    float exit = exit_x < exit_y ? exit_x : exit_y;
+    if (enter >= exit || enter > 1.0f || exit <= 0.0f) {
+        return false;
+    }
+
+    if (enter < 0.0f) {
+        hit->time = 0.0f;
+        hit->axis = SWEEP_OVERLAP;
+    }
+    else {
+        hit->time = enter;
+        hit->axis = enter_x > enter_y ? SWEEP_X : SWEEP_Y;
+    }
+    return true;
+}
+
+bool check_collision(FRect a, FRect b) {
+    // Check if there is a gap between the two rectangles
+    if (a.x + a.w <= b.x || // a is to the left of b
+        a.x >= b.x + b.w || // a is to the right of b
+        a.y + a.h <= b.y || // a is above b
+        a.y >= b.y + b.h) { // a is below b
+        return false; // No collision
+    }
+    return true; // Collision detected
+}
+
+// Function to initialize an object
+void initializeObject(Eggs* eggs, Rng* rng, int i) {
+    // Ensure the slot is in use
+    if (i < 0 || i >= eggs->count) {
+        fprintf(stderr, "Error: Trying to initialize object %d of %d\n", i, eggs->count);
+        return;
+    }
+
+    // Add bounds checking
+    eggs->x[i] = (float)rng_below(rng, WINDOW_WIDTH - EGG_SIZE); // Ensure width is not exceeded
+    eggs->y[i] = -100;
+    eggs->speedY[i] = 0;
+    eggs->gravity[i] = (float)(rng_below(rng, 5) + 1) / 50.0f;
+
+    // Ensure consistent object dimensions
+    eggs->width[i] = EGG_SIZE;
+    eggs->height[i] = EGG_SIZE;
+}
+
+// FNV-1a over the bytes of a block of state
+static unsigned int hash_bytes(unsigned int hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+unsigned int game_checksum(const Game* game) {
+    int counters[6] = {
+        game->is_game_over, game->level_complete, game->current_level,
+        game->total_objects_to_collect, game->collected_objects, game->to_collect
+    };
+    const Eggs* eggs = &game->eggs;
+    size_t floats = sizeof(float) * eggs->count;
+
+    unsigned int hash = 2166136261u;
+    hash = hash_bytes(hash, counters, sizeof(counters));
+    hash = hash_bytes(hash, &game->ball, sizeof(game->ball));
+    hash = hash_bytes(hash, &game->block, sizeof(game->block));
+    hash = hash_bytes(hash, &eggs->count, sizeof(eggs->count));
+    hash = hash_bytes(hash, eggs->x, floats);
+    hash = hash_bytes(hash, eggs->y, floats);
+    hash = hash_bytes(hash, eggs->speedY, floats);
+    hash = hash_bytes(hash, eggs->gravity, floats);
+    hash = hash_bytes(hash, &game->spawn_rng, sizeof(game->spawn_rng));
+    return hash;
+}
+
+// Fixed part of a state image, the egg arrays follow it
+typedef struct {
+    int counters[6];
+    Ball ball;
+    Block block;
+    Floor ground;
+    Rng spawn_rng;
+    Animator chicken;
+    int chicken_facing;
+    int egg_count;
+    int num_free;
+} GameStateHeader;
+
+// Per egg: x, y, speedY, gravity, width, height and the id, then the free ids
+#define STATE_EGG_FLOATS 6
+#define STATE_EGG_BYTES (sizeof(float) * STATE_EGG_FLOATS + sizeof(int))
+
+size_t game_state_max_size(const GameConfig* config) {
+    return sizeof(GameStateHeader) + (STATE_EGG_BYTES + sizeof(int)) * config_capacity(config);
+}
+
+size_t game_save_state(const Game* game, void* out) {
+    const Eggs* eggs = &game->eggs;
+    GameStateHeader header;
+    memset(&header, 0, sizeof(header));  // Padding too, so equal states give equal bytes
+
+    header.counters[0] = game->is_game_over;
+    header.counters[1] = game->level_complete;
+    header.counters[2] = game->current_level;
+    header.counters[3] = game->total_objects_to_collect;
+    header.counters[4] = game->collected_objects;
+    header.counters[5] = game->to_collect;
+    header.ball = game->ball;
+    header.block = game->block;
+    header.ground = game->ground;
+    header.spawn_rng = game->spawn_rng;
+    header.chicken = game->chicken;
+    header.chicken_facing = game->chicken_facing;
+    header.egg_count = eggs->count;
+    header.num_free = eggs->num_free;
+
+    unsigned char* p = out;
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+
+    const float* arrays[STATE_EGG_FLOATS] = { eggs->x, eggs->y, eggs->speedY, eggs->gravity, eggs->width, eggs->height };
+    for (int a = 0; a < STATE_EGG_FLOATS; a++) {
+        memcpy(p, arrays[a], sizeof(float) * eggs->count);
+        p += sizeof(float) * eggs->count;
+    }
+    memcpy(p, eggs->ids, sizeof(int) * eggs->count);
+    p += sizeof(int) * eggs->count;
+    memcpy(p, eggs->free_ids, sizeof(int) * eggs->num_free);
+    p += sizeof(int) * eggs->num_free;
+
+    return (size_t)(p - (unsigned char*)out);
+}
+
+int game_load_state(Game* game, const void* data, size_t size) {
+    Eggs* eggs = &game->eggs;
+    GameStateHeader header;
+    if (size < sizeof(header)) {
+        return FALSE;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (header.egg_count < 0 || header.num_free < 0 || header.egg_count + header.num_free != eggs->capacity ||
+        size != sizeof(header) + STATE_EGG_BYTES * header.egg_count + sizeof(int) * header.num_free) {
+        return FALSE;
+    }
+
+    game->is_game_over = header.counters[0];
+    game->level_complete = header.counters[1];
+    game->current_level = header.counters[2];
+    game->total_objects_to_collect = header.counters[3];
+    game->collected_objects = header.counters[4];
+    game->to_collect = header.counters[5];
+    game->ball = header.ball;
+    game->block = header.block;
+    game->ground = header.ground;
+    game->spawn_rng = header.spawn_rng;
+    game->chicken = header.chicken;
+    game->chicken_facing = header.chicken_facing;
+    eggs->count = header.egg_count;
+    eggs->num_free = header.num_free;
+
+    const unsigned char* p = (const unsigned char*)data + sizeof(header);
+    float* arrays[STATE_EGG_FLOATS] = { eggs->x, eggs->y, eggs->speedY, eggs->gravity, eggs->width, eggs->height };
+    for (int a = 0; a < STATE_EGG_FLOATS; a++) {
+        memcpy(arrays[a], p, sizeof(float) * eggs->count);
+        p += sizeof(float) * eggs->count;
+    }
+    memcpy(eggs->ids, p, sizeof(int) * eggs->count);
+    p += sizeof(int) * eggs->count;
+    memcpy(eggs->free_ids, p, sizeof(int) * eggs->num_free);
+
+    // Everything else follows from the eggs
+    for (int id = 0; id < eggs->capacity; id++) {
+        eggs->index_of[id] = -1;
+    }
+    for (int i = 0; i < eggs->count; i++) {
+        eggs->index_of[eggs->ids[i]] = i;
+    }
+    eggs_clear_hits(eggs);
+    eggs_store_previous(eggs);
+    grid_clear(&game->grid, eggs->capacity);
+    grid_update(&game->grid, eggs);
+    game_clear_events(game);
+
+    return TRUE;
+}
+
+// Fixed timestep helpers
+
+// Remembers where everything was before the next tick so rendering can blend between ticks
+void store_previous_state(Game* game) {
+    game->ball.prev_x = game->ball.x;
+    game->ball.prev_y = game->ball.y;
+    game->block.prev_x = game->block.x;
+    game->block.prev_y = game->block.y;
+
+    eggs_store_previous(&game->eggs);
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+// Game logic only, no SDL in here so it can run headless (benchmarks, CI)
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "constants.h"
+#include "anim.h"
+#include "eggs.h"
+#include "grid.h"
+#include "rng.h"
+
+// Gravity
+#define GRAVITY 0.2
+
+// Meteor Objects
+#define NUM_OBJECTS 10
+
+#define INITIAL_OBJECTS 10
+
+// Eggs are square, in pixels
+#define EGG_SIZE 20
+
+// Broad-phase cell size in pixels, a few eggs wide
+#define GRID_CELL_SIZE 64
+
+// From this many eggs on, update() splits the egg integration over the job system (jobs.h)
+#define PARALLEL_MIN_EGGS 4096
+#define PARALLEL_GRAIN 2048     // Eggs per chunk
+
+// Effects queued by update() between two game_clear_events(), extra ones are dropped
+#define GAME_MAX_EVENTS 256
+
+// Input buttons held during a tick
+#define INPUT_LEFT  0x01 // A
+#define INPUT_RIGHT 0x02 // D
+#define INPUT_FAST  0x04 // Shift, chicken moves faster
+#define INPUT_BOOST 0x08 // Space, psychic boost for the bag
+
+// Structs
+typedef struct {
+    float x, y;        // Position
+    float prev_x, prev_y; // Position at the previous sim tick, used for interpolation
+    float vx, vy;      // Velocity
+    float width, height; // Dimensions
+} Ball;
+
+typedef struct {
+    float x, y;        // Position
+    float prev_x, prev_y; // Position at the previous sim tick, used for interpolation
+    float vx, vy;      // Velocity
+    float width, height; // Dimensions
+} Block;
+
+typedef struct {
+    float x, y;
+    float width, height;
+} Floor;
+
+// Axis a swept collision came in on
+#define SWEEP_OVERLAP 0     // Already overlapping when the tick started
+#define SWEEP_X 1
+#define SWEEP_Y 2
+
+typedef struct {
+    float time;         // Fraction of the tick, 0..1
+    int axis;
+} SweepHit;
+
+// Something the renderer shows an effect for
+enum {
+    GAME_EVENT_SPLAT,       // An egg hit the ground, at the point it landed
+    GAME_EVENT_CATCH,       // An egg went into the bag
+    GAME_EVENT_LEVEL_UP     // At the chicken
+};
+
+typedef struct {
+    int type;
+    float x, y;
+} GameEvent;
+
+// What one chunk of the parallel integrate pass found, update() takes the largest
+typedef struct {
+    float max_step;     // Furthest an egg of the chunk fell this tick
+} EggChunk;
+
+typedef struct {
+    int capacity;       // Size of the egg pool, the most eggs that can fall at once
+    int egg_count;      // Forces the number of falling eggs on level 1 (later levels scale it), 0 follows the level rules
+    int quiet;          // No console messages, for headless runs
+    int serial;         // update() never uses the job system, for callers already running games in parallel
+    float ball_width, ball_height;   // Sprite sizes, main.c sets them from the loaded textures
+    float block_width, block_height;
+} GameConfig;
+
+typedef struct {
+    GameConfig config;
+
+    int is_game_over;
+    int level_complete;
+    int current_level;
+    int total_objects_to_collect;   // Eggs kept falling on this level, never more than the pool holds
+    int collected_objects;
+    int to_collect;     // Catches needed to finish the level
+
+    Ball ball;
+    Block block;
+    Floor ground;
+
+    Rng spawn_rng;      // RNG_STREAM_SPAWN, everything the game randomizes
+
+    // Chicken animation, only drawn, so it's left out of the checksum
+    Animator chicken;
+    int chicken_facing;     // -1 left, 1 right
+
+    // Pool of falling eggs, only the active ones are stored
+    Eggs eggs;
+    Grid grid;          // Broad-phase over the eggs, refiled after every integrate pass
+    EggChunk* chunks;   // One per PARALLEL_GRAIN eggs of the pool
+    void* egg_memory;   // Backs eggs, grid and chunks, NULL when the caller owns it (game_attach)
+
+    // Queued for the renderer, not part of the simulation state
+    GameEvent events[GAME_MAX_EVENTS];
+    int num_events;
+} Game;
+
+// Function Declarations
+void game_default_config(GameConfig* config);
+int game_init(Game* game, const GameConfig* config); // Allocates the eggs, returns FALSE on failure
+void game_free(Game* game);
+
+// Same as game_init() in memory the caller owns, game_memory_size() bytes of it. game_free() leaves it alone.
+size_t game_memory_size(const GameConfig* config);
+void game_attach(Game* game, const GameConfig* config, void* memory);
+void setup(Game* game);  // Resets the state for the current level
+void update(Game* game, unsigned int input, float delta_time); // Advances one fixed tick
+void reset_game(Game* game);
+void increase_level_difficulty(Game* game);
+
+// Eggs a level asks for, before the pool's capacity caps it. The only place the count is decided.
+int game_egg_count(const GameConfig* config, int level);
+
+// Functionalities
+bool check_collision(FRect a, FRect b);
+
+// Continuous collision: a moves by (dx, dy) over a tick while b stays put (pass the motion
+// relative to b when both move). Fills in when they first touch, 0..1 of the tick, and on
+// which axis, so fast objects can't pass through each other between two ticks.
+bool sweep_collision(FRect a, FRect b, float dx, float dy, SweepHit* hit);
+void initializeObject(Eggs* eggs, Rng* rng, int i);
+
+// Fixed timestep helpers
+void store_previous_state(Game* game);
+
+// The renderer takes game->events, then clears them
+void game_clear_events(Game* game);
+
+// Seeds the game's random streams, after game_init() and before setup()
+void game_seed(Game* game, unsigned int seed);
+
+// Hash of the simulation state, two runs with the same seed and inputs must match tick for tick
+unsigned int game_checksum(const Game* game);
+
+// The simulation state as a flat image: counters, bag, chicken, random stream and the active
+// eggs, no pointers. Loading it back and running the same inputs gives the same ticks.
+size_t game_state_max_size(const GameConfig* config);
+size_t game_save_state(const Game* game, void* out);    // Returns the bytes written
+int game_load_state(Game* game, const void* data, size_t size);  // FALSE if it doesn't fit this game
+
+// Number of heap allocations / bytes made by the game module, for the benchmark
+size_t game_allocation_count();
+size_t game_allocated_bytes();
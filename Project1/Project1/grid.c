@@ -0,0 +1,149 @@
+// Built_in_library
+#include <string.h>
+
+// Other_includes
+#include "grid.h"
+
+static int grid_cols(float width, float cell_size) {
+    return (int)(width / cell_size) + 1;
+}
+
+static int grid_rows(float height, float cell_size) {
+    return (int)(height / cell_size) + 1;
+}
+
+size_t grid_memory_size(int capacity, float width, float height, float cell_size) {
+    size_t cells = (size_t)grid_cols(width, cell_size) * grid_rows(height, cell_size);
+    return sizeof(int) * (cells + (size_t)capacity * 3);
+}
+
+void grid_attach(Grid* grid, void* memory, int capacity, float width, float height, float cell_size) {
+    memset(grid, 0, sizeof(*grid));
+    grid->cols = grid_cols(width, cell_size);
+    grid->rows = grid_rows(height, cell_size);
+    grid->cell_size = cell_size;
+    grid->inv_cell_size = 1.0f / cell_size;
+
+    int* p = memory;
+    grid->head = p; p += grid->cols * grid->rows;
+    grid->next = p; p += capacity;
+    grid->prev = p; p += capacity;
+    grid->cell = p;
+
+    grid_clear(grid, capacity);
+}
+
+void grid_clear(Grid* grid, int capacity) {
+    memset(grid->head, 0xff, sizeof(int) * grid->cols * grid->rows);
+    memset(grid->cell, 0xff, sizeof(int) * capacity);
+    grid->max_w = 0;
+    grid->max_h = 0;
+}
+
+static int clamp(int value, int low, int high) {
+    if (value < low) return low;
+    if (value > high) return high;
+    return value;
+}
+
+// Cells are clamped at the edges, so eggs that fell below the screen still land in the bottom row
+static int column_of(const Grid* grid, float x) {
+    return clamp(x < 0 ? 0 : (int)(x * grid->inv_cell_size), 0, grid->cols - 1);
+}
+
+static int row_of(const Grid* grid, float y) {
+    return clamp(y < 0 ? 0 : (int)(y * grid->inv_cell_size), 0, grid->rows - 1);
+}
+
+static void file_egg(Grid* grid, int i, int c) {
+    grid->cell[i] = c;
+    grid->prev[i] = -1;
+    grid->next[i] = grid->head[c];
+    if (grid->head[c] >= 0) grid->prev[grid->head[c]] = i;
+    grid->head[c] = i;
+}
+
+static void unfile_egg(Grid* grid, int i) {
+    int c = grid->cell[i];
+    if (c < 0) return;
+
+    if (grid->prev[i] >= 0) grid->next[grid->prev[i]] = grid->next[i];
+    else grid->head[c] = grid->next[i];
+    if (grid->next[i] >= 0) grid->prev[grid->next[i]] = grid->prev[i];
+
+    grid->cell[i] = -1;
+}
+
+void grid_update(Grid* grid, const Eggs* eggs) {
+    const float* x = eggs->x;
+    const float* y = eggs->y;
+    const float* height = eggs->height;
+    int* cell = grid->cell;
+
+    for (int i = 0; i < eggs->count; i++) {
+        int c = -1;
+        if (y[i] + height[i] > 0) {
+            c = row_of(grid, y[i]) * grid->cols + column_of(grid, x[i]);
+        }
+
+        // Most eggs stay in their cell from one tick to the next
+        if (c == cell[i]) continue;
+
+        unfile_egg(grid, i);
+        if (c >= 0) {
+            file_egg(grid, i, c);
+            if (eggs->width[i] > grid->max_w) grid->max_w = eggs->width[i];
+            if (eggs->height[i] > grid->max_h) grid->max_h = eggs->height[i];
+        }
+    }
+}
+
+void grid_remove(Grid* grid, const Eggs* eggs, int i) {
+    int last = eggs->count - 1;
+    unfile_egg(grid, i);
+
+    // eggs_remove() moves the last egg into slot i, file it under its new index
+    if (i != last) {
+        int c = grid->cell[last];
+        unfile_egg(grid, last);
+        if (c >= 0) file_egg(grid, i, c);
+    }
+}
+
+static int overlaps(const Eggs* eggs, int i, FRect r) {
+    return eggs->x[i] + eggs->width[i] > r.x && eggs->x[i] < r.x + r.w &&
+        eggs->y[i] + eggs->height[i] > r.y && eggs->y[i] < r.y + r.h;
+}
+
+static int query(const Grid* grid, const Eggs* eggs, FRect rect, int skip, int* out, int max) {
+    // Eggs are filed by their top-left corner, so look far enough up and left to catch any that reach in
+    int col0 = column_of(grid, rect.x - grid->max_w);
+    int col1 = column_of(grid, rect.x + rect.w);
+    int row0 = row_of(grid, rect.y - grid->max_h);
+    int row1 = row_of(grid, rect.y + rect.h);
+
+    if (rect.y + rect.h <= 0) {
+        return 0;
+    }
+
+    int found = 0;
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            for (int i = grid->head[row * grid->cols + col]; i >= 0; i = grid->next[i]) {
+                if (i == skip || !overlaps(eggs, i, rect)) continue;
+                if (found == max) return found;
+                out[found++] = i;
+            }
+        }
+    }
+    return found;
+}
+
+int grid_query(const Grid* grid, const Eggs* eggs, FRect rect, int* out, int max) {
+    return query(grid, eggs, rect, -1, out, max);
+}
+
+int grid_query_egg(const Grid* grid, const Eggs* eggs, int i, int* out, int max) {
+    FRect rect = { eggs->x[i], eggs->y[i], eggs->width[i], eggs->height[i] };
+    return query(grid, eggs, rect, i, out, max);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Uniform grid over the play area for egg collision queries.
+// Eggs are filed by their top-left corner, each cell keeps a linked list of egg indices,
+// and grid_update() only relinks the eggs that changed cell since the last tick.
+// Eggs entirely above the screen aren't filed, nothing on screen can touch them.
+
+#include <stddef.h>
+
+#include "eggs.h"
+
+typedef struct {
+    float x, y;
+    float w, h;
+} FRect;
+
+typedef struct {
+    int cols, rows;
+    float cell_size;
+    float inv_cell_size;
+    float max_w, max_h;  // Biggest egg filed so far, queries are widened by it
+
+    int* head;           // First egg in each cell, -1 when empty
+    int* next;           // Per egg links inside its cell
+    int* prev;
+    int* cell;           // Cell of each egg, -1 when not filed
+} Grid;
+
+size_t grid_memory_size(int capacity, float width, float height, float cell_size);
+void grid_attach(Grid* grid, void* memory, int capacity, float width, float height, float cell_size);
+
+void grid_clear(Grid* grid, int capacity);     // Unfiles every egg
+void grid_update(Grid* grid, const Eggs* eggs); // Refiles the eggs that moved to another cell
+
+// Keep the grid in sync with eggs_remove(): call before it with the same index
+void grid_remove(Grid* grid, const Eggs* eggs, int i);
+
+// Writes the indices of the eggs overlapping rect into out, returns how many (up to max)
+int grid_query(const Grid* grid, const Eggs* eggs, FRect rect, int* out, int max);
+
+// Same for the eggs touching egg i, for egg-egg mechanics
+int grid_query_egg(const Grid* grid, const Eggs* eggs, int i, int* out, int max);
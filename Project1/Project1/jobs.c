@@ -0,0 +1,311 @@
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Other_includes
+#include "constants.h"
+#include "jobs.h"
+
+// Threads, locks and atomics, Win32 or pthreads / GCC builtins
+#ifdef _WIN32
+typedef HANDLE JobThread;
+typedef SRWLOCK JobLock;
+typedef CONDITION_VARIABLE JobCond;
+
+static void lock_init(JobLock* lock) { InitializeSRWLock(lock); }
+static void lock_destroy(JobLock* lock) { (void)lock; }
+static void lock_acquire(JobLock* lock) { AcquireSRWLockExclusive(lock); }
+static void lock_release(JobLock* lock) { ReleaseSRWLockExclusive(lock); }
+static void cond_init(JobCond* cond) { InitializeConditionVariable(cond); }
+static void cond_destroy(JobCond* cond) { (void)cond; }
+static void cond_wait(JobCond* cond, JobLock* lock) { SleepConditionVariableSRW(cond, lock, INFINITE, 0); }
+static void cond_signal(JobCond* cond) { WakeConditionVariable(cond); }
+static void cond_broadcast(JobCond* cond) { WakeAllConditionVariable(cond); }
+
+// Full barriers, like the GCC versions below
+static long atomic_add(volatile long* value, long amount) { return InterlockedExchangeAdd(value, amount) + amount; }
+static long atomic_get(volatile long* value) { return InterlockedCompareExchange(value, 0, 0); }
+#else
+typedef pthread_t JobThread;
+typedef pthread_mutex_t JobLock;
+typedef pthread_cond_t JobCond;
+
+static void lock_init(JobLock* lock) { pthread_mutex_init(lock, NULL); }
+static void lock_destroy(JobLock* lock) { pthread_mutex_destroy(lock); }
+static void lock_acquire(JobLock* lock) { pthread_mutex_lock(lock); }
+static void lock_release(JobLock* lock) { pthread_mutex_unlock(lock); }
+static void cond_init(JobCond* cond) { pthread_cond_init(cond, NULL); }
+static void cond_destroy(JobCond* cond) { pthread_cond_destroy(cond); }
+static void cond_wait(JobCond* cond, JobLock* lock) { pthread_cond_wait(cond, lock); }
+static void cond_signal(JobCond* cond) { pthread_cond_signal(cond); }
+static void cond_broadcast(JobCond* cond) { pthread_cond_broadcast(cond); }
+
+static long atomic_add(volatile long* value, long amount) { return __atomic_add_fetch(value, amount, __ATOMIC_SEQ_CST); }
+static long atomic_get(volatile long* value) { return __atomic_load_n(value, __ATOMIC_SEQ_CST); }
+#endif
+
+// A range of chunks of the current parallel_for, [first, last)
+typedef struct {
+    int first, last;
+} Job;
+
+// Jobs in [top, bottom), the owner works at the bottom and thieves at the top
+typedef struct {
+    JobLock lock;
+    Job jobs[JOBS_DEQUE_SIZE];
+    int top, bottom;
+} Deque;
+
+// Deque 0 belongs to the submitting thread, the workers have the others
+static Deque deques[JOBS_MAX_THREADS];
+static JobThread threads[JOBS_MAX_THREADS];
+static int thread_count = 1;
+static int num_deques = 1;             // Fixed while the workers run, deques of threads that failed to start stay empty
+
+// Idle threads sleep on wake, a push signals one of them and the last chunk wakes them all
+static JobLock sleep_lock;
+static JobCond wake;
+static volatile long sleepers = 0;
+static volatile long queued = 0;        // Jobs sitting in the deques
+static int shutting_down = 0;
+
+// The parallel_for being run, set before its first job is pushed
+static JobFn batch_fn;
+static void* batch_data;
+static int batch_count;
+static int batch_grain;
+static volatile long batch_remaining = 0; // Chunks not finished yet
+
+int jobs_core_count() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+#endif
+}
+
+int jobs_thread_count() {
+    return thread_count;
+}
+
+int jobs_chunk_count(int count, int grain) {
+    if (count <= 0) return 0;
+    if (grain < 1) grain = 1;
+    return (count + grain - 1) / grain;
+}
+
+// Returns FALSE when the deque is full, the caller then runs the job itself
+static int push_job(int self, Job job) {
+    Deque* deque = &deques[self];
+
+    lock_acquire(&deque->lock);
+    if (deque->bottom == JOBS_DEQUE_SIZE && deque->top > 0) {
+        memmove(deque->jobs, deque->jobs + deque->top, sizeof(Job) * (deque->bottom - deque->top));
+        deque->bottom -= deque->top;
+        deque->top = 0;
+    }
+    int pushed = deque->bottom < JOBS_DEQUE_SIZE;
+    if (pushed) {
+        deque->jobs[deque->bottom++] = job;
+    }
+    lock_release(&deque->lock);
+
+    if (!pushed) return FALSE;
+
+    // Both counters are full barriers: either a thread going to sleep sees the job, or we see it sleeping
+    atomic_add(&queued, 1);
+    if (atomic_get(&sleepers) > 0) {
+        lock_acquire(&sleep_lock);
+        cond_signal(&wake);
+        lock_release(&sleep_lock);
+    }
+    return TRUE;
+}
+
+// Newest job from our own deque, or the oldest one from somebody else's
+static int take_job(int self, Job* job) {
+    for (int n = 0; n < num_deques; n++) {
+        Deque* deque = &deques[(self + n) % num_deques];
+        int found = FALSE;
+
+        lock_acquire(&deque->lock);
+        if (deque->bottom > deque->top) {
+            *job = n == 0 ? deque->jobs[--deque->bottom] : deque->jobs[deque->top++];
+            if (deque->bottom == deque->top) deque->top = deque->bottom = 0;
+            found = TRUE;
+        }
+        lock_release(&deque->lock);
+
+        if (found) {
+            atomic_add(&queued, -1);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void run_chunks(int first, int last) {
+    for (int c = first; c < last; c++) {
+        int begin = c * batch_grain;
+        int end = begin + batch_grain < batch_count ? begin + batch_grain : batch_count;
+        batch_fn(batch_data, c, begin, end);
+    }
+}
+
+static void run_job(int self, Job job) {
+    // Leave the upper halves for the others, keep the first chunk
+    while (job.last - job.first > 1) {
+        int middle = job.first + (job.last - job.first) / 2;
+        Job upper = { middle, job.last };
+        if (!push_job(self, upper)) break;
+        job.last = middle;
+    }
+
+    run_chunks(job.first, job.last);
+
+    if (atomic_add(&batch_remaining, -(long)(job.last - job.first)) == 0) {
+        lock_acquire(&sleep_lock);
+        cond_broadcast(&wake);
+        lock_release(&sleep_lock);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker(LPVOID data)
+#else
+static void* worker(void* data)
+#endif
+{
+    int self = (int)(size_t)data;
+
+    for (;;) {
+        Job job;
+        if (take_job(self, &job)) {
+            run_job(self, job);
+            continue;
+        }
+
+        lock_acquire(&sleep_lock);
+        atomic_add(&sleepers, 1);
+        while (!shutting_down && atomic_get(&queued) == 0) {
+            cond_wait(&wake, &sleep_lock);
+        }
+        atomic_add(&sleepers, -1);
+        int done = shutting_down;
+        lock_release(&sleep_lock);
+
+        if (done) break;
+    }
+    return 0;
+}
+
+int jobs_init(int threads_wanted) {
+    if (thread_count > 1) {
+        return thread_count;
+    }
+
+    if (threads_wanted <= 0) threads_wanted = jobs_core_count();
+    if (threads_wanted > JOBS_MAX_THREADS) threads_wanted = JOBS_MAX_THREADS;
+    if (threads_wanted <= 1) return 1;
+
+    lock_init(&sleep_lock);
+    cond_init(&wake);
+    shutting_down = 0;
+    for (int i = 0; i < threads_wanted; i++) {
+        lock_init(&deques[i].lock);
+        deques[i].top = deques[i].bottom = 0;
+    }
+
+    num_deques = threads_wanted;
+    thread_count = 1;
+    for (int i = 1; i < threads_wanted; i++) {
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, worker, (LPVOID)(size_t)i, 0, NULL);
+        int started = threads[i] != NULL;
+#else
+        int started = pthread_create(&threads[i], NULL, worker, (void*)(size_t)i) == 0;
+#endif
+        if (!started) {
+            fprintf(stderr, "Error: Could not start job thread %d\n", i);
+            break;
+        }
+        thread_count = i + 1;
+    }
+    return thread_count;
+}
+
+void jobs_shutdown() {
+    if (thread_count <= 1) {
+        return;
+    }
+
+    lock_acquire(&sleep_lock);
+    shutting_down = 1;
+    cond_broadcast(&wake);
+    lock_release(&sleep_lock);
+
+    for (int i = 1; i < thread_count; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    for (int i = 0; i < num_deques; i++) {
+        lock_destroy(&deques[i].lock);
+    }
+    cond_destroy(&wake);
+    lock_destroy(&sleep_lock);
+    thread_count = 1;
+    num_deques = 1;
+}
+
+void jobs_parallel_for(int count, int grain, JobFn fn, void* data) {
+    int chunks = jobs_chunk_count(count, grain);
+    if (chunks == 0) return;
+
+    batch_fn = fn;
+    batch_data = data;
+    batch_count = count;
+    batch_grain = grain < 1 ? 1 : grain;
+
+    // Nobody to share with
+    if (thread_count == 1 || chunks == 1) {
+        run_chunks(0, chunks);
+        return;
+    }
+
+    atomic_add(&batch_remaining, chunks);
+    Job root = { 0, chunks };
+    run_job(0, root);
+
+    // Help with whatever is left, sleep when the rest is already being run
+    while (atomic_get(&batch_remaining) > 0) {
+        Job job;
+        if (take_job(0, &job)) {
+            run_job(0, job);
+            continue;
+        }
+
+        lock_acquire(&sleep_lock);
+        atomic_add(&sleepers, 1);
+        while (atomic_get(&batch_remaining) > 0 && atomic_get(&queued) == 0) {
+            cond_wait(&wake, &sleep_lock);
+        }
+        atomic_add(&sleepers, -1);
+        lock_release(&sleep_lock);
+    }
+}
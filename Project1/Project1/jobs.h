@@ -0,0 +1,35 @@
+#pragma once
+
+// Small work-stealing job system for the game logic. No SDL in here, so bench uses it too.
+// Every thread has its own deque of jobs: it pushes and pops at the bottom, and a thread
+// with nothing to do steals from the top of another one. A job is a range of chunks,
+// the thread running it keeps halving it and pushes the upper halves, so the other
+// threads always find big pieces to steal.
+//
+// jobs_parallel_for() splits [0, count) into fixed chunks of grain items. The chunk
+// boundaries don't depend on the thread count or on who runs what, so callers can write
+// per-chunk results and reduce them in chunk order to get the same answer every time.
+//
+// Only one thread submits work: the one that called jobs_init() or, after that,
+// whichever thread the game runs on. It runs chunks too while it waits.
+
+// Limits for the job system
+#define JOBS_MAX_THREADS 16
+#define JOBS_DEQUE_SIZE 64      // Halving keeps at most log2(chunks) jobs in a deque
+
+// Called once per chunk, begin / end are item indices
+typedef void (*JobFn)(void* data, int chunk, int begin, int end);
+
+// Starts threads - 1 workers next to the submitting thread, 0 picks one per core.
+// Returns the thread count, 1 means everything runs inline.
+int jobs_init(int threads);
+void jobs_shutdown();
+
+int jobs_thread_count();   // Including the submitting thread, 1 before jobs_init()
+int jobs_core_count();
+
+// Chunks needed for count items
+int jobs_chunk_count(int count, int grain);
+
+// Runs fn on every chunk and returns once they're all done
+void jobs_parallel_for(int count, int grain, JobFn fn, void* data);
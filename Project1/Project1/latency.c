@@ -0,0 +1,130 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Other_includes
+#include "constants.h"
+#include "latency.h"
+
+static const char* span_names[LATENCY_SPANS] = { "poll_to_tick", "tick_to_submit", "submit_to_present", "total" };
+
+static int compare_float(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+void latency_init(Latency* latency) {
+    memset(latency, 0, sizeof(*latency));
+    latency->next_id = 1;
+}
+
+unsigned int latency_probe(Latency* latency, double poll_time) {
+    // Nothing is reaching the screen (paused, stalled), the oldest probe gives up its place
+    if (latency->num_pending == LATENCY_MAX_PENDING) {
+        memmove(latency->pending, latency->pending + 1, sizeof(LatencyProbe) * (LATENCY_MAX_PENDING - 1));
+        latency->num_pending--;
+        latency->dropped++;
+    }
+
+    LatencyProbe* probe = &latency->pending[latency->num_pending++];
+    probe->id = latency->next_id++;
+    probe->poll = poll_time;
+    return probe->id;
+}
+
+void latency_frame(Latency* latency, unsigned int probe, double tick_time, double submit_time, double present_time) {
+    if (probe == 0 || probe == latency->done_id) {
+        return;
+    }
+    latency->done_id = probe;
+
+    // Pending probes are in id order, everything up to this one is done
+    int done = 0;
+    while (done < latency->num_pending && latency->pending[done].id <= probe) {
+        const LatencyProbe* pending = &latency->pending[done++];
+        if (pending->id != probe) {
+            latency->superseded++;
+            continue;
+        }
+
+        int slot = (int)(latency->count % LATENCY_MAX_SAMPLES);
+        latency->ms[LATENCY_POLL_TO_TICK][slot] = (float)((tick_time - pending->poll) * 1000.0);
+        latency->ms[LATENCY_TICK_TO_SUBMIT][slot] = (float)((submit_time - tick_time) * 1000.0);
+        latency->ms[LATENCY_SUBMIT_TO_PRESENT][slot] = (float)((present_time - submit_time) * 1000.0);
+        latency->ms[LATENCY_TOTAL][slot] = (float)((present_time - pending->poll) * 1000.0);
+        latency->count++;
+    }
+
+    latency->num_pending -= done;
+    memmove(latency->pending, latency->pending + done, sizeof(LatencyProbe) * latency->num_pending);
+}
+
+int latency_sample_count(const Latency* latency) {
+    return latency->count < LATENCY_MAX_SAMPLES ? (int)latency->count : LATENCY_MAX_SAMPLES;
+}
+
+void latency_percentiles(const Latency* latency, int span, double* p50, double* p95, double* p99, double* max) {
+    static float sorted[LATENCY_MAX_SAMPLES];
+    int count = latency_sample_count(latency);
+
+    if (count == 0) {
+        *p50 = *p95 = *p99 = *max = 0.0;
+        return;
+    }
+
+    memcpy(sorted, latency->ms[span], sizeof(float) * count);
+    qsort(sorted, count, sizeof(float), compare_float);
+
+    *p50 = sorted[(count - 1) * 50 / 100];
+    *p95 = sorted[(count - 1) * 95 / 100];
+    *p99 = sorted[(count - 1) * 99 / 100];
+    *max = sorted[count - 1];
+}
+
+const char* latency_span_name(int span) {
+    return (span >= 0 && span < LATENCY_SPANS) ? span_names[span] : "?";
+}
+
+void latency_report(const Latency* latency) {
+    printf("Latency: %lu inputs (%lu superseded, %lu dropped), last %d in ms\n",
+        latency->count, latency->superseded, latency->dropped, latency_sample_count(latency));
+    printf("  %-18s %8s %8s %8s %8s\n", "span", "p50", "p95", "p99", "max");
+    for (int span = 0; span < LATENCY_SPANS; span++) {
+        double p50, p95, p99, max;
+        latency_percentiles(latency, span, &p50, &p95, &p99, &max);
+        printf("  %-18s %8.2f %8.2f %8.2f %8.2f\n", span_names[span], p50, p95, p99, max);
+    }
+}
+
+int latency_export_csv(const Latency* latency, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Latency: can't write %s\n", path);
+        return FALSE;
+    }
+
+    fprintf(file, "sample");
+    for (int span = 0; span < LATENCY_SPANS; span++) {
+        fprintf(file, ",%s_ms", span_names[span]);
+    }
+    fprintf(file, "\n");
+
+    // Oldest first
+    int count = latency_sample_count(latency);
+    unsigned long first = latency->count - (unsigned long)count;
+    for (int i = 0; i < count; i++) {
+        int slot = (int)((first + i) % LATENCY_MAX_SAMPLES);
+        fprintf(file, "%lu", first + i);
+        for (int span = 0; span < LATENCY_SPANS; span++) {
+            fprintf(file, ",%.3f", latency->ms[span][slot]);
+        }
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    return TRUE;
+}
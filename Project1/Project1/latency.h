@@ -0,0 +1,68 @@
+#pragma once
+
+// Input-to-photon latency (--latency). No SDL in here, the caller passes every timestamp in
+// seconds off one clock. A probe is one steering change (A / D pressed or released), followed
+// through the pipeline:
+//   poll     the render thread took the key event out of SDL's queue
+//   tick     the first sim tick that ran with the new buttons finished
+//   submit   the first frame showing that tick was handed to the renderer
+//   present  SDL_RenderPresent returned for that frame
+// With vsync present returns around the flip. The display's own scanout and response time come
+// on top, software can't see those.
+//
+// If a newer probe reaches a snapshot before an older one was drawn (two changes inside one
+// tick), the older one is counted as superseded and left out of the samples.
+
+// Limits for the latency probes
+#define LATENCY_MAX_PENDING 64
+#define LATENCY_MAX_SAMPLES 4096
+
+// Spans each sample is split into
+enum {
+    LATENCY_POLL_TO_TICK,
+    LATENCY_TICK_TO_SUBMIT,
+    LATENCY_SUBMIT_TO_PRESENT,
+    LATENCY_TOTAL,          // Poll to present
+    LATENCY_SPANS
+};
+
+typedef struct {
+    unsigned int id;
+    double poll;
+} LatencyProbe;
+
+typedef struct {
+    unsigned int next_id;   // Probe ids start at 1, 0 means none
+    unsigned int done_id;   // Newest probe that made it to the screen
+
+    LatencyProbe pending[LATENCY_MAX_PENDING];
+    int num_pending;
+
+    // Ring of the newest samples, milliseconds per span
+    float ms[LATENCY_SPANS][LATENCY_MAX_SAMPLES];
+    unsigned long count;    // Samples taken, the ring keeps the last LATENCY_MAX_SAMPLES
+    unsigned long superseded;
+    unsigned long dropped;  // More than LATENCY_MAX_PENDING in flight
+} Latency;
+
+void latency_init(Latency* latency);
+
+// Render thread, an input change was polled. Returns the probe id to hand the sim thread.
+unsigned int latency_probe(Latency* latency, double poll_time);
+
+// Render thread, after a present. probe and tick_time come from the snapshot that was drawn.
+void latency_frame(Latency* latency, unsigned int probe, double tick_time, double submit_time, double present_time);
+
+// Samples in the ring
+int latency_sample_count(const Latency* latency);
+
+// Nearest rank percentiles of a span over the samples in the ring, in milliseconds
+void latency_percentiles(const Latency* latency, int span, double* p50, double* p95, double* p99, double* max);
+
+const char* latency_span_name(int span);
+
+// Table of every span to stdout
+void latency_report(const Latency* latency);
+
+// One row per sample, one column per span
+int latency_export_csv(const Latency* latency, const char* path);
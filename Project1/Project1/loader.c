@@ -0,0 +1,188 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+
+// User_defined_library
+#include <SDL.h>
+#include <SDL_image.h>
+
+// Other_includes
+#include "constants.h"
+#include "archive.h"
+#include "loader.h"
+
+#define QUEUE_MASK (LOADER_MAX_JOBS - 1)
+
+// Bounded multi-producer queue: each cell's sequence says whose turn it is,
+// so workers claim cells with a CAS and the main thread never takes a lock
+typedef struct {
+    SDL_atomic_t sequence;
+    int job;
+    SDL_Surface* surface;
+} QueueCell;
+
+static QueueCell queue[LOADER_MAX_JOBS];
+static SDL_atomic_t enqueue_pos;
+static int dequeue_pos = 0;     // Only the main thread reads the queue
+
+static const char* job_paths[LOADER_MAX_JOBS];
+static int num_jobs = 0;
+static SDL_atomic_t next_job;
+static int jobs_done = 0;
+static int jobs_failed = 0;
+
+static SDL_Thread* threads[LOADER_MAX_THREADS];
+static int num_threads = 0;
+
+// Opened once and only read by the workers
+static Archive archive;
+
+static void push(int job, SDL_Surface* surface) {
+    int pos = SDL_AtomicGet(&enqueue_pos);
+    for (;;) {
+        QueueCell* cell = &queue[pos & QUEUE_MASK];
+        int diff = SDL_AtomicGet(&cell->sequence) - pos;
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&enqueue_pos, pos, pos + 1)) {
+                cell->job = job;
+                cell->surface = surface;
+                SDL_AtomicSet(&cell->sequence, pos + 1);
+                return;
+            }
+        }
+        // Another worker took this cell, start over from the current end.
+        // The queue holds every job, so it can't be full.
+        pos = SDL_AtomicGet(&enqueue_pos);
+    }
+}
+
+static int pop(int* job, SDL_Surface** surface) {
+    QueueCell* cell = &queue[dequeue_pos & QUEUE_MASK];
+    if (SDL_AtomicGet(&cell->sequence) != dequeue_pos + 1) {
+        return FALSE;
+    }
+
+    *job = cell->job;
+    *surface = cell->surface;
+    SDL_AtomicSet(&cell->sequence, dequeue_pos + LOADER_MAX_JOBS);
+    dequeue_pos++;
+    return TRUE;
+}
+
+// Wraps the archive's pixels without copying them, or decodes the file if it isn't packed
+static SDL_Surface* load_surface(const char* path) {
+    const ArchiveEntry* entry = archive_find(&archive, path);
+    if (entry) {
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)archive_pixels(&archive, entry),
+            (int)entry->width, (int)entry->height, 32, (int)entry->pitch, entry->format);
+        if (!surface) {
+            fprintf(stderr, "SDL_CreateRGBSurfaceWithFormatFrom: %s\n", SDL_GetError());
+        }
+        return surface;
+    }
+
+    printf("Loader: %s isn't in %s, decoding it\n", path, ASSET_ARCHIVE);
+    SDL_Surface* surface = IMG_Load(path);
+    if (!surface) {
+        fprintf(stderr, "Error loading image: %s\n", IMG_GetError());
+    }
+    return surface;
+}
+
+static int worker(void* data) {
+    (void)data;
+    for (;;) {
+        int job = SDL_AtomicAdd(&next_job, 1);
+        if (job >= num_jobs) {
+            return 0;
+        }
+        push(job, load_surface(job_paths[job]));
+    }
+}
+
+int loader_start(const char** paths, int count) {
+    if (count > LOADER_MAX_JOBS) {
+        fprintf(stderr, "Loader: %d files, only %d fit in the queue\n", count, LOADER_MAX_JOBS);
+        count = LOADER_MAX_JOBS;
+    }
+
+    memcpy(job_paths, paths, sizeof(*paths) * count);
+    num_jobs = count;
+    jobs_done = 0;
+    jobs_failed = 0;
+    dequeue_pos = 0;
+    SDL_AtomicSet(&next_job, 0);
+    SDL_AtomicSet(&enqueue_pos, 0);
+    for (int i = 0; i < LOADER_MAX_JOBS; i++) {
+        SDL_AtomicSet(&queue[i].sequence, i);
+    }
+
+    // A missing archive just means every file gets decoded
+    archive_open(&archive, ASSET_ARCHIVE);
+
+    // IMG_Init isn't thread safe, do it here if any worker will need a decoder
+    for (int i = 0; i < count; i++) {
+        if (!archive_find(&archive, paths[i])) {
+            if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+                fprintf(stderr, "Error Initializing SDL_image: %s\n", IMG_GetError());
+            }
+            break;
+        }
+    }
+
+    // Leave a core for the main thread, it keeps the loading screen going
+    int wanted = SDL_GetCPUCount() - 1;
+    if (wanted > count) wanted = count;
+    if (wanted > LOADER_MAX_THREADS) wanted = LOADER_MAX_THREADS;
+    if (wanted < 1) wanted = 1;
+
+    num_threads = 0;
+    for (int i = 0; i < wanted; i++) {
+        threads[num_threads] = SDL_CreateThread(worker, "loader", NULL);
+        if (!threads[num_threads]) {
+            fprintf(stderr, "SDL_CreateThread: %s\n", SDL_GetError());
+            break;
+        }
+        num_threads++;
+    }
+
+    if (num_threads == 0) {
+        archive_close(&archive);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+int loader_poll(SDL_Surface** surfaces) {
+    int job;
+    SDL_Surface* surface;
+    while (pop(&job, &surface)) {
+        surfaces[job] = surface;
+        if (!surface) jobs_failed++;
+        jobs_done++;
+    }
+    return jobs_done;
+}
+
+int loader_failed() {
+    return jobs_failed;
+}
+
+void loader_finish() {
+    // Whatever is still queued has nowhere to go, workers stop at the next job
+    SDL_AtomicSet(&next_job, num_jobs);
+    for (int i = 0; i < num_threads; i++) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    num_threads = 0;
+
+    int job;
+    SDL_Surface* surface;
+    while (pop(&job, &surface)) {
+        SDL_FreeSurface(surface);
+    }
+
+    archive_close(&archive);
+}
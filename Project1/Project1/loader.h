@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SDL.h>
+
+// Background image decoding. Worker threads take paths off a shared counter, wrap the
+// packed pixels from the asset archive or decode the PNG / SVG, and hand the surfaces
+// back through a lock-free queue. Textures are still created on the main thread, which
+// keeps drawing a loading screen meanwhile.
+
+// Limits for the loader, LOADER_MAX_JOBS must be a power of two
+#define LOADER_MAX_JOBS 256
+#define LOADER_MAX_THREADS 8
+
+// Starts decoding the files, returns FALSE if nothing could be started
+int loader_start(const char** paths, int count);
+
+// Moves the surfaces finished since the last call into surfaces[job index],
+// returns how many jobs are done so far. Failed jobs count as done with a NULL surface.
+int loader_poll(SDL_Surface** surfaces);
+
+int loader_failed();    // Number of files that couldn't be loaded
+
+// Waits for the workers and closes the archive. Surfaces from the archive point into
+// the mapped file, so only call this once they have been uploaded or copied.
+void loader_finish();
@@ -13,14 +13,22 @@
 
 // Other_includes
 #include "constants.h"
-
-// Gravity
-#define GRAVITY 0.2
-
-// Meteor Objects
-#define NUM_OBJECTS 10 
-
-#define INITIAL_OBJECTS 10
+#include "text.h"
+#include "display.h"
+#include "pacer.h"
+#include "latency.h"
+#include "sprites.h"
+#include "scene.h"
+#include "resources.h"
+#include "loader.h"
+#include "profiler.h"
+#include "replay.h"
+#include "rewind.h"
+#include "snapshot.h"
+#include "jobs.h"
+#include "particles.h"
+#include "rng.h"
+#include "game.h"
 
 // Global SDL Pointers
 SDL_Window* window;
@@ -28,96 +36,366 @@ SDL_Renderer* renderer;
 
 // Global Variables
 int game_is_running = 0;
-int is_game_over = 0;
-int last_frame_time = 0;
-int restart_requested = 0;
-int current_level = 1;
-int total_objects_to_collect = NUM_OBJECTS;
-int collected_objects = 0;
-int level_complete = 0;
-int to_collect;
-
-// Global textures
-SDL_Texture* ball_texture;
-SDL_Texture* block_texture;
-SDL_Texture* object_texture;
-SDL_Texture* background;
-
-// Structs
-struct Ball {
-    float x, y;        // Position
-    float vx, vy;      // Velocity
-    float width, height; // Dimensions
-}ball;
-
-struct Block {
-    float x, y;        // Position
-    float vx, vy;      // Velocity
-    float width, height; // Dimensions
-}block;
-
-struct Floor {
-    float x, y;       
-    float width, height;
-}ground;
-
-typedef struct {
-    float x, y;
-    float speedY; // Vertical speed
-    float gravity;
-    int width, height;
-    int is_active;
-} Object;
-
-// Struct Array for the Object struct
-Object objects[NUM_OBJECTS];
+int sim_hz = SIM_HZ;
+int show_profiler = 0;
+int paused = 0;         // P, or the window lost focus
+int needs_redraw = 1;   // A static screen is out of date
+int fullscreen = 0;     // F11 or --fullscreen
+float fixed_scale = 0;  // --scale, pins the scene scale instead of following the frame time
+
+// Frame pacing, see pacer.h. --pace picks the mode, --fps the rate for "cap".
+Pacer pacer;
+int pace_mode = PACE_VSYNC;
+int cap_fps = FPS;
+int vsync_applied = -1;     // What the renderer is set to, -1 before the first frame
+double submit_time = 0.0;   // Seconds (performance counter) around the last SDL_RenderPresent
+double present_time = 0.0;
+
+// Input latency (--latency), see latency.h. --inject N measures N synthetic steering changes and quits.
+Latency latency;
+int measure_latency = 0;
+unsigned int input_probe = 0;       // Newest steering change, handed to the sim thread with the buttons
+int inject_total = 0;
+int injected = 0;
+unsigned int injected_input = 0;    // Buttons the injector is holding down
+double next_inject = 0.0;
+Uint32 inject_event = (Uint32)-1;   // Carries the injected buttons through the event queue
+Rng inject_rng;
+
+// Gaps between injected changes, uneven so they don't line up with the frames or the ticks
+#define INJECT_MIN_GAP 0.15
+#define INJECT_MAX_GAP 0.4
+#define INJECT_TIMEOUT 2.0  // Seconds after the last one before giving up on what's still in flight
+
+// Input recording / replay, see replay.h
+const char* record_path = NULL;
+const char* replay_path = NULL;
+Replay replay;
+
+// Game state, see game.c. Only the sim thread touches it once simulate() runs.
+Game game;
+
+// Sim thread and what it shares with the render (main) thread
+SDL_Thread* sim_thread = NULL;
+SDL_sem* sim_wake = NULL;       // Posted to get the sim thread out of its idle wait
+SDL_atomic_t sim_running;
+SDL_atomic_t sim_input;         // INPUT_* buttons, sampled once per rendered frame
+SDL_atomic_t sim_probe;         // Latency probe those buttons carry, 0 for none
+SDL_atomic_t sim_paused;
+SDL_atomic_t sim_restart;       // Enter was pressed on the game over screen
+SDL_atomic_t sim_rewind;        // R was pressed
+Rewind history;                 // Sim thread only, off while recording or replaying
+SDL_atomic_t sim_done;          // The replay ran out
+Uint32 sim_event = (Uint32)-1;  // Pushed by the sim thread to wake an idle render loop
+
+SnapshotBuffer snapshots;
+const Snapshot* view = NULL;    // Newest snapshot, what this frame draws
+
+// Effects, render thread only. They move with the frame time, not the sim ticks.
+Particles particles;
+unsigned int particle_serial = 0;   // Last snapshot whose events became particles
+Uint64 particle_counter = 0;        // When the particles last moved, 0 after a static screen
+
 
 // Function Declarations
 int initializeWindow();
-void setup();  // Initializes the values only once, this is not inside the game loop
+int load_assets(GameConfig* config);
 void process_input();
-void update();
-void render();
+void handle_event(const SDL_Event* event);
+void set_paused(int value);
+int is_idle();
+int unattended();
+int is_steering(SDL_Scancode scancode);
+void wait_for_events();
+int start_simulation();
+void stop_simulation();
+int simulate(void* data);
+void wake_renderer();
+void update_particles(Uint64 now);
+unsigned int read_input();
+void inject_input();
+double counter_seconds();
+void render(float alpha);
+double refresh_rate();
+void apply_vsync();
 void destroy_window();
-void reset_game();
-void increase_level_difficulty();
 
 // Functionalities
-bool check_collision(SDL_Rect a, SDL_Rect b);
-void initializeObject(Object* obj);
 void renderGameOverScreen(SDL_Renderer* renderer);
+void renderLoadingScreen(SDL_Renderer* renderer, int done, int total);
+void renderProfilerOverlay(SDL_Renderer* renderer);
+
+// Canvas for scene.c: sprites go into the atlas batch, text through the glyph cache
+void canvas_sprite(void* context, int sprite, const SceneRect* dst, SceneColor color, int flip_x);
+void canvas_fill(void* context, const SceneRect* dst, SceneColor color);
+void canvas_text(void* context, const char* font_path, int font_size, const char* text, int x, int y, SceneColor color);
+void canvas_sprite_size(void* context, int sprite, int* width, int* height);
+Canvas canvas = { NULL, canvas_sprite, canvas_fill, canvas_text, canvas_sprite_size };
 
 int main(int argc, char* argv[]) {
-    
+
+    // Options: "--hz 240" sim rate, "--seed N", "--record FILE" / "--replay FILE" for input logs,
+    // "--capacity N" size of the egg pool (later levels want more eggs than the default holds),
+    // "--threads N" sim thread plus job workers for big pools, 1 (the default) keeps everything on the sim thread,
+    // "--scale F" fixed scene resolution (0.25 to 1 of the window), "--fullscreen",
+    // "--pace vsync|adaptive|uncapped|cap" frame pacing, "--fps N" rate for the cap,
+    // "--latency" measures input to present latency, "--inject N" with N synthetic inputs
+    unsigned int seed = 1;
+    int capacity = NUM_OBJECTS;
+    int threads = 1;
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--hz") == 0) {
+            sim_hz = atoi(argv[i + 1]);
+        }
+        if (strcmp(argv[i], "--seed") == 0) {
+            seed = (unsigned int)strtoul(argv[i + 1], NULL, 10);
+        }
+        if (strcmp(argv[i], "--record") == 0) {
+            record_path = argv[i + 1];
+        }
+        if (strcmp(argv[i], "--replay") == 0) {
+            replay_path = argv[i + 1];
+        }
+        if (strcmp(argv[i], "--capacity") == 0) {
+            capacity = atoi(argv[i + 1]);
+        }
+        if (strcmp(argv[i], "--threads") == 0) {
+            threads = atoi(argv[i + 1]);
+        }
+        if (strcmp(argv[i], "--scale") == 0) {
+            fixed_scale = (float)atof(argv[i + 1]);
+        }
+        if (strcmp(argv[i], "--pace") == 0) {
+            pace_mode = pacer_mode_from_name(argv[i + 1]);
+            if (pace_mode < 0) {
+                printf("Unknown --pace %s, using vsync\n", argv[i + 1]);
+                pace_mode = PACE_VSYNC;
+            }
+        }
+        if (strcmp(argv[i], "--fps") == 0) {
+            cap_fps = atoi(argv[i + 1]);
+        }
+        if (strcmp(argv[i], "--inject") == 0) {
+            inject_total = atoi(argv[i + 1]);
+        }
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fullscreen") == 0) {
+            fullscreen = TRUE;
+        }
+        if (strcmp(argv[i], "--latency") == 0) {
+            measure_latency = TRUE;
+        }
+    }
+    if (inject_total > 0) {
+        measure_latency = TRUE;
+        rng_seed(&inject_rng, seed, RNG_STREAM_INPUT);
+    }
+    if (measure_latency) {
+        latency_init(&latency);
+    }
+
+    // A replay brings its own seed and sim rate
+    if (replay_path) {
+        if (!replay_load(&replay, replay_path)) {
+            return 1;
+        }
+        seed = replay.header.seed;
+        sim_hz = (int)replay.header.sim_hz;
+        record_path = NULL;
+    }
+    if (sim_hz < MIN_SIM_HZ) sim_hz = MIN_SIM_HZ;
+    if (sim_hz > MAX_SIM_HZ) sim_hz = MAX_SIM_HZ;
+
+    const double sim_dt = 1.0 / sim_hz;
+    const double counter_frequency = (double)SDL_GetPerformanceFrequency();
+
+    // Phase timers are cheap enough to keep on, F3 shows them and F4 saves them
+    profiler_init();
+    profiler_enabled = TRUE;
+
+    // Cold start timing, the window and the assets are reported separately
+    Uint64 startup_counter = SDL_GetPerformanceCounter();
     game_is_running = initializeWindow();
-    setup();
+    Uint64 window_counter = SDL_GetPerformanceCounter();
+
+    GameConfig config;
+    game_default_config(&config);
+    config.capacity = capacity;
+    if (game_is_running) {
+        game_is_running = load_assets(&config);
+    }
+    if (game_is_running && replay_path) {
+        // Sprite sizes change the collisions, so they must match the recording
+        if (replay.header.ball_width != config.ball_width || replay.header.block_width != config.block_width) {
+            printf("Replay: recorded with different sprite sizes, it will drift\n");
+        }
+        replay_config(&replay, &config);
+    }
+    if (game_is_running && record_path) {
+        replay_init(&replay, seed, sim_hz, &config);
+    }
+    if (game_is_running) {
+        game_is_running = game_init(&game, &config) && particles_init(&particles, PARTICLE_CAPACITY);
+    }
+
+    // Jumping back in time isn't in the input log, so there's no rewinding a recording or a replay
+    if (game_is_running && !record_path && !replay_path) {
+        game_is_running = rewind_init(&history, &config, REWIND_DEFAULT_BYTES, REWIND_HISTORY_SECONDS * sim_hz);
+    }
+    if (game_is_running) {
+        game_seed(&game, seed);
+        setup(&game);
+
+        Uint64 ready_counter = SDL_GetPerformanceCounter();
+        printf("Startup: %.1f ms (window %.1f ms, assets %.1f ms)\n",
+            (ready_counter - startup_counter) * 1000.0 / counter_frequency,
+            (window_counter - startup_counter) * 1000.0 / counter_frequency,
+            (ready_counter - window_counter) * 1000.0 / counter_frequency);
+    }
+
+    // Off unless asked for, see the scaling numbers in the README. 0 takes every core but this one's.
+    if (game_is_running && threads == 0) {
+        threads = jobs_core_count() - 1;
+    }
+    if (game_is_running && threads > 1) {
+        jobs_init(threads);
+    }
 
-    // Game Loop
+    // From here on the sim thread owns the game, this thread only reads its snapshots
+    if (game_is_running) {
+        game_is_running = start_simulation();
+    }
+
+    // The cap runs at --fps, the vsync modes at the display's refresh rate
+    pacer_init(&pacer, pace_mode, pace_mode == PACE_CAP ? cap_fps : refresh_rate());
+    if (game_is_running) {
+        apply_vsync();
+    }
+    int shown_level = 1;
+
+    // Render Loop
     while (game_is_running) {
+        view = snapshot_acquire(&snapshots);
+        if (SDL_AtomicGet(&sim_done)) {
+            break;
+        }
+
+        // Nothing moves on the game over and pause screens: draw them once, then sleep until an event
+        if (is_idle()) {
+            particle_counter = 0;
+            if (needs_redraw) {
+                if (view->is_game_over) {
+                    particles_clear(&particles);
+                    renderGameOverScreen(renderer);
+                }
+                else {
+                    render(1.0f);
+                }
+                needs_redraw = FALSE;
+            }
+
+            wait_for_events();
+            pacer_resume(&pacer);
+            continue;
+        }
+
+        Uint64 frame_start = SDL_GetPerformanceCounter();
+        profiler_frame_begin();
+
+        PROFILE_BEGIN(PROF_INPUT);
+        if (inject_total > 0) {
+            inject_input();
+        }
         process_input();
 
-        // If game is over, only render the game over screen
-        if (is_game_over) {
-            renderGameOverScreen(renderer);
+        // Buttons before the probe, the sim thread reads them the other way round
+        SDL_AtomicSet(&sim_input, (int)read_input());
+        SDL_AtomicSet(&sim_probe, (int)input_probe);
+        PROFILE_END(PROF_INPUT);
 
-            // Check for restart
-            if (restart_requested) {
-                reset_game();
-            }
+        // Paused or quit by the events above, the idle branch takes over next iteration
+        if (is_idle() || !game_is_running) {
+            profiler_frame_end();
+            continue;
         }
-        else if (level_complete) {
-            // Level completed, continue to next level
-            level_complete = 0;
+
+        // Level completed, setup() only resets state, so with the F3 overlay on these should read
+        // the same on every level
+        if (show_profiler && view->current_level > shown_level) {
+            printf("Textures: %d live, %zu KB\n", resource_texture_count(), resource_texture_bytes() / 1024);
         }
-        else {
-            update();
-            render();
+        shown_level = view->current_level;
+
+        // Blend from the snapshot's last tick towards the next one, replays run too fast for that
+        float alpha = 1.0f;
+        if (!replay_path) {
+            alpha = (float)((frame_start / counter_frequency - view->time) / sim_dt);
+            if (alpha < 0.0f) alpha = 0.0f;
+            if (alpha > 1.0f) alpha = 1.0f;
+        }
+        update_particles(frame_start);
+        Uint64 render_start = SDL_GetPerformanceCounter();
+        render(alpha);
+        double render_ms = (SDL_GetPerformanceCounter() - render_start) * 1000.0 / counter_frequency;
+        if (measure_latency) {
+            latency_frame(&latency, view->input_probe, view->input_probe_time, submit_time, present_time);
+        }
+
+        // Wait for the next frame (or let vsync do it), the sim thread keeps its own pace
+        int vsync_on = vsync_applied && !pacer.vsync_broken;
+        pacer_frame_end(&pacer);
+        apply_vsync();
+
+        // A vsync present mostly waits for the display, that isn't drawing time
+        double present_ms = (present_time - submit_time) * 1000.0;
+        display_frame_time(vsync_on ? render_ms - present_ms : render_ms, pacer.interval * 1000.0, pacer.last_missed);
+
+        // Whatever static screen comes next has to be drawn over this frame
+        needs_redraw = TRUE;
+        profiler_frame_end();
+    }
+
+    stop_simulation();
+    jobs_shutdown();
+
+    if (pacer.frames > 0) {
+        double mean, jitter, worst;
+        pacer_stats(&pacer, &mean, &jitter, &worst);
+        printf("Frames: %lu (%s), %.2f ms mean, %.2f ms jitter, %.2f ms worst, %lu missed\n",
+            pacer.frames, pacer_mode_name(pacer.mode), mean, jitter, worst, pacer.missed);
+    }
+
+    int result = 0;
+    if (measure_latency) {
+        latency_report(&latency);
+        if (latency_export_csv(&latency, "latency.csv")) {
+            printf("Latency: saved latency.csv\n");
+        }
+        // An injected run that never got an input to the screen failed
+        if (inject_total > 0 && latency.count == 0) {
+            result = 1;
         }
     }
 
+    if (replay_path) {
+        printf("Replay: %u of %u ticks, %d checksum mismatches\n", replay.tick, replay.header.num_ticks, replay.mismatches);
+        if (replay.mismatches) result = 1;
+        replay_free(&replay);
+    }
+    if (record_path) {
+        if (replay_save(&replay, record_path)) {
+            printf("Replay: saved %u ticks to %s\n", replay.header.num_ticks, record_path);
+        }
+        replay_free(&replay);
+    }
+
+    game_free(&game);
+    rewind_free(&history);
+    particles_free(&particles);
     destroy_window();
     
-    return 0;
+    return result;
 }
 
 // Function definitions
@@ -134,7 +412,7 @@ int initializeWindow() {
         SDL_WINDOWPOS_CENTERED,
         WINDOW_WIDTH,
         WINDOW_HEIGHT,
-        SDL_WINDOW_BORDERLESS
+        SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI | (fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0)
     );
     if (!window) {
         fprintf(stderr, "Error Initializing Window: %s\n", SDL_GetError());
@@ -149,40 +427,19 @@ int initializeWindow() {
         SDL_Quit();
         return FALSE;
     }
+    SDL_SetWindowMinimumSize(window, WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2);
 
-    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
-        fprintf(stderr, "Error Initializing SDL_image: %s\n", IMG_GetError());
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return FALSE;
-    }
-
-    SDL_Surface* bg_surface = IMG_Load("assets/forest_bg.png");
-    if (!bg_surface) {
-        fprintf(stderr, "Failed to load background image: %s\n", IMG_GetError());
-        IMG_Quit();
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return FALSE;
-    }
-
-    background = SDL_CreateTextureFromSurface(renderer, bg_surface);
-    SDL_FreeSurface(bg_surface);
-    if (!background) {
-        fprintf(stderr, "Failed to create background texture: %s\n", SDL_GetError());
-        IMG_Quit();
+    // The scene goes through an offscreen target, the window can be any size
+    if (!display_init(renderer, fixed_scale)) {
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
         return FALSE;
     }
 
+    // SDL_image isn't initialized here, sprites.c only needs it when the asset archive is missing
     if (TTF_Init() == -1) {
         fprintf(stderr, "SDL_ttf Initialization Error: %s\n", TTF_GetError());
-        SDL_DestroyTexture(background);
-        IMG_Quit();
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
@@ -193,504 +450,530 @@ int initializeWindow() {
 }
 
 int renderTextWithFont(SDL_Renderer* renderer, const char* fontPath, const char* text, int x, int y, Uint8 r, Uint8 g, Uint8 b, int fontSize) {
-    // Open the specified font
-    TTF_Font* font = TTF_OpenFont("assets/Pixeltype.ttf", fontSize);
-    if (!font) {
-        printf("TTF_OpenFont: %s\n", TTF_GetError());
-        return -1;
-    }
-
-    SDL_Color color = { r, g, b, 255 };
-    SDL_Surface* surface = TTF_RenderText_Blended(font, text, color);
-    if (!surface) {
-        printf("TTF_RenderText_Blended: %s\n", TTF_GetError());
-        TTF_CloseFont(font);
-        return -1;
-    }
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!texture) {
-        printf("SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
-        SDL_FreeSurface(surface);
-        TTF_CloseFont(font);
-        return -1;
-    }
-
-    // Center the text horizontally
-    int centerX = x - (surface->w / 2);
-    int centerY = y - (surface->h / 2);
-
-    SDL_Rect dstrect = { centerX, centerY, surface->w, surface->h };
-    SDL_RenderCopy(renderer, texture, NULL, &dstrect);
-
-    // Clean up
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-    TTF_CloseFont(font);
+    // Fonts and glyph atlases are cached by the text module, so this no longer opens the font every call
+    return text_draw(renderer, fontPath, fontSize, text, x, y, r, g, b);
+}
 
-    return 0;
+// Draws text with its left edge at x, text_draw() centers it
+void renderTextLeft(SDL_Renderer* renderer, const char* text, int x, int y, Uint8 r, Uint8 g, Uint8 b) {
+    int width = 0;
+    text_measure(renderer, TEXT_DEFAULT_FONT, 18, text, &width, NULL);
+    text_draw(renderer, TEXT_DEFAULT_FONT, 18, text, x + width / 2, y, r, g, b);
 }
 
-SDL_Texture* load_texture(const char* file_path, int* width, int* height) {
-    SDL_Surface* surface = IMG_Load(file_path);
-    if (!surface) {
-        fprintf(stderr, "Error loading image: %s\n", IMG_GetError());
-        return NULL;
-    }
+// Decodes the sprites on the loader threads behind a loading screen,
+// then packs them into the atlas and tells the game how big they are
+int load_assets(GameConfig* config) {
+    int ball_width, ball_height;
+    int block_width, block_height;
 
-    if (width) *width = surface->w;
-    if (height) *height = surface->h;
+    const char* paths[SPRITE_COUNT];
+    int job_sprites[SPRITE_COUNT];
+    int num_jobs = 0;
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (assets_sprite_file(i)) {
+            job_sprites[num_jobs] = i;
+            paths[num_jobs++] = assets_sprite_file(i);
+        }
+    }
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
+    SDL_Surface* loaded[SPRITE_COUNT] = { 0 };
+    if (!loader_start(paths, num_jobs)) {
+        return FALSE;
+    }
 
-    return texture;
-}
+    // Keep the window responsive, Escape still quits while loading
+    int done = 0;
+    Uint32 last_draw = 0;
+    while (done < num_jobs && game_is_running) {
+        process_input();
+        done = loader_poll(loaded);
 
-// Render Text
-int renderText(SDL_Renderer* renderer, const char* text, int x, int y, Uint8 r, Uint8 g, Uint8 b) {
-    // Open a larger font to ensure full text visibility
-    TTF_Font* font = TTF_OpenFont("assets/Pixeltype.ttf", 36); // Reduced font size from 50
-    if (!font) {
-        printf("TTF_OpenFont: %s\n", TTF_GetError());
-        return -1;
+        // The first pass draws straight away, then once a frame. Vsync isn't on yet, so drawing
+        // every pass would spin on the core the loader threads want.
+        if (last_draw == 0 || SDL_GetTicks() - last_draw >= FRAME_TARGET_TIME) {
+            renderLoadingScreen(renderer, done, num_jobs);
+            last_draw = SDL_GetTicks();
+        }
+        else {
+            SDL_Delay(1);
+        }
     }
 
-    SDL_Color color = { r, g, b, 255 };
-    SDL_Surface* surface = TTF_RenderText_Blended(font, text, color); // Changed to Blended for better quality
-    if (!surface) {
-        printf("TTF_RenderText_Blended: %s\n", TTF_GetError());
-        TTF_CloseFont(font);
-        return -1;
+    SDL_Surface* surfaces[SPRITE_COUNT] = { 0 };
+    for (int j = 0; j < num_jobs; j++) {
+        surfaces[job_sprites[j]] = loaded[j];
     }
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!texture) {
-        printf("SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
-        SDL_FreeSurface(surface);
-        TTF_CloseFont(font);
-        return -1;
+    // Archive surfaces point into the mapped file, so the loader closes it after the upload
+    int built = game_is_running && loader_failed() == 0 && sprites_build(renderer, surfaces);
+    if (!built) {
+        for (int i = 0; i < SPRITE_COUNT; i++) SDL_FreeSurface(surfaces[i]);
+    }
+    loader_finish();
+    if (!built) {
+        return FALSE;
     }
 
-    // Center the text horizontally
-    int centerX = x - (surface->w / 2);
-    int centerY = y - (surface->h / 2);
+    // The HUD font, so the first frame doesn't rasterize it
+    text_measure(renderer, TEXT_DEFAULT_FONT, 24, "", NULL, NULL);
 
-    SDL_Rect dstrect = { centerX, centerY, surface->w, surface->h };
-    SDL_RenderCopy(renderer, texture, NULL, &dstrect);
+    sprites_size(SPRITE_BAG, &ball_width, &ball_height);
+    sprites_size(SPRITE_CHICKEN, &block_width, &block_height);
 
-    // Clean up
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-    TTF_CloseFont(font);
+    // Update ball and block dimensions to match the loaded textures
+    config->ball_width = ball_width;
+    config->ball_height = ball_height;
+    config->block_width = block_width;
+    config->block_height = block_height;
 
-    return 0;
+    return TRUE;
 }
 
-void setup() {
-
-    to_collect = 10 + (current_level - 1) * 2;
-
-    // Reset collected objects
-    is_game_over = 0;
-    collected_objects = 0;
-    level_complete = 0;
-
-    // Ball
-    ball.x = 500;
-    ball.y = 500;
-    ball.width = 15;
-    ball.height = 15;
-    ball.vx = 200;
-    ball.vy = 150;
-
-    // Block
-    block.width = 90;
-    block.height = 40;
-    block.vx = 200;
-    block.vy = 100;
-    block.x = 400;
-    block.y = WINDOW_HEIGHT - block.height;
-
-    // Ground
-    ground.width = WINDOW_WIDTH;
-    ground.height = 20; // Small height for ground
-    ground.x = 0;
-    ground.y = WINDOW_HEIGHT - ground.height; // Place at bottom of the screen
-
-    int ball_width, ball_height;
-    int block_width, block_height;
-    int object_width, object_height;
-    
-    ball_texture = load_texture("assets/bag.png", &ball_width, &ball_height);
-    block_texture = load_texture("assets/chickenidle2.png", &block_width, &block_height);
-
-    object_texture = load_texture("assets/egg.png", &object_width, &object_height);
+void process_input() {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        handle_event(&event);
+    }
+}
 
-    // Update block dimensions to match the loaded texture
-    ball.width = ball_width;
-    ball.height = ball_height;
+void handle_event(const SDL_Event* event) {
+    switch (event->type) {
+    case SDL_QUIT:
+        game_is_running = FALSE;
+        break;
+    case SDL_KEYDOWN:
+        if (event->key.keysym.sym == SDLK_ESCAPE) {
+            game_is_running = FALSE;
+        }
 
-    // Update block dimensions to match the loaded texture
-    block.width = block_width;
-    block.height = block_height;
+        // Add restart functionality
+        if (view && view->is_game_over && event->key.keysym.sym == SDLK_RETURN) {
+            SDL_AtomicSet(&sim_restart, 1);
+            SDL_SemPost(sim_wake);
+        }
 
-    // Adjust block position to align with the ground
-    block.x = 400;
-    block.y = WINDOW_HEIGHT - block.height - ground.height; // Ensure it sits just above the ground
+        // Steering changes are followed to the screen, not while paused since no tick would take them
+        if (measure_latency && !paused && !event->key.repeat && is_steering(event->key.keysym.scancode)) {
+            input_probe = latency_probe(&latency, counter_seconds());
+        }
 
-    if (current_level == 1) {
-        total_objects_to_collect = INITIAL_OBJECTS;
-    }
-    else {
-        total_objects_to_collect = INITIAL_OBJECTS + (current_level * 2);
-    }
+        // Psychic rewind, works on the game over screen too
+        if (event->key.keysym.sym == SDLK_r && !event->key.repeat) {
+            SDL_AtomicSet(&sim_rewind, 1);
+            SDL_SemPost(sim_wake);
+        }
 
-    // Create an array of objects
-    for (int i = 0; i < NUM_OBJECTS; i++) {
-        if (i < total_objects_to_collect) {
-            initializeObject(&objects[i]);
-            objects[i].is_active = 1;
+        if (event->key.keysym.sym == SDLK_p && !event->key.repeat) {
+            set_paused(!paused);
+        }
 
-            // Ensure each object has a unique starting position
-            // Add some randomness to prevent overlapping
-            objects[i].x = rand() % (WINDOW_WIDTH - objects[i].width);
-            objects[i].y = -100 - (i * 50); // Stagger the starting heights
+        // Profiler overlay and export
+        if (event->key.keysym.sym == SDLK_F3) {
+            show_profiler = !show_profiler;
+            needs_redraw = TRUE;
         }
-        else {
-            objects[i].is_active = 0;
+        if (event->key.keysym.sym == SDLK_F11 && !event->key.repeat) {
+            fullscreen = !fullscreen;
+            SDL_SetWindowFullscreen(window, fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0);
+            needs_redraw = TRUE;
+        }
+        if (event->key.keysym.sym == SDLK_F4) {
+            if (profiler_export_csv("profile.csv") && profiler_export_trace("profile_trace.json")) {
+                printf("Profiler: saved profile.csv and profile_trace.json\n");
+            }
+        }
+        break;
+    case SDL_KEYUP:
+        if (measure_latency && !paused && is_steering(event->key.keysym.scancode)) {
+            input_probe = latency_probe(&latency, counter_seconds());
+        }
+        break;
+    case SDL_WINDOWEVENT:
+        // Pause when the player switches away, a replay or an injected run keeps going unattended
+        if ((event->window.event == SDL_WINDOWEVENT_FOCUS_LOST || event->window.event == SDL_WINDOWEVENT_MINIMIZED) && !unattended()) {
+            set_paused(TRUE);
         }
 
-        // Update object dimensions to match the loaded texture
-        objects[i].width = objects[i].width;
-        objects[i].height = objects[i].height;
-    }
+        // The window contents may be gone, a static screen has to be drawn again
+        if (event->window.event == SDL_WINDOWEVENT_EXPOSED || event->window.event == SDL_WINDOWEVENT_RESTORED ||
+            event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+            needs_redraw = TRUE;
+        }
+        if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+            display_reset();
+        }
 
-}
-void process_input() {
-    SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-        switch (event.type) {
-        case SDL_QUIT:
-            game_is_running = FALSE;
-            break;
-        case SDL_KEYDOWN:
-            if (event.key.keysym.sym == SDLK_ESCAPE) {
-                game_is_running = FALSE;
-            }
+        // Moved to a screen with another refresh rate
+        if (event->window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED && pacer.mode != PACE_CAP) {
+            pacer_set_rate(&pacer, refresh_rate());
+        }
+        break;
+    case SDL_RENDER_TARGETS_RESET:
+        // The offscreen scene was lost, it's redrawn every frame but a static screen needs a nudge
+        needs_redraw = TRUE;
+        break;
+    default:
+        // The sim thread published something the idle screen has to show
+        if (event->type == sim_event) {
+            needs_redraw = TRUE;
+        }
 
-            // Add restart functionality
-            if (is_game_over && event.key.keysym.sym == SDLK_RETURN) {
-                restart_requested = 1;
-            }
-            break;
+        // Polled like a key, so it's timed from the same point
+        if (event->type == inject_event) {
+            injected_input = (unsigned int)event->user.code;
+            input_probe = latency_probe(&latency, counter_seconds());
         }
+        break;
     }
 }
 
+void set_paused(int value) {
+    paused = value;
+    needs_redraw = TRUE;
+    SDL_AtomicSet(&sim_paused, value);
+    if (sim_wake) SDL_SemPost(sim_wake);
+}
 
-void update() {
-
-    const Uint8* key_state = SDL_GetKeyboardState(NULL);
-
-    // Calculate the time elapsed since the last frame
-    int current_time = SDL_GetTicks();
-    float delta_time = (current_time - last_frame_time) / 1000.0f;
+// Game over and pause only change on input, so they don't need a frame loop.
+// A replay or an injected run restarts on its own, its game over never waits for a key.
+int is_idle() {
+    return (view && view->is_game_over && !unattended()) || paused;
+}
 
-    // Update the last frame time for the next frame
-    last_frame_time = current_time;
+int unattended() {
+    return replay_path != NULL || inject_total > 0;
+}
 
-    // Ball / Bag Speed Multiplier
-    float ball_speed_multiplier = 1.0f;
+// Keys that steer the chicken, what the latency mode follows
+int is_steering(SDL_Scancode scancode) {
+    return scancode == SDL_SCANCODE_A || scancode == SDL_SCANCODE_D;
+}
 
-    if (key_state[SDL_SCANCODE_SPACE]) {
-        ball_speed_multiplier = 3.0f; // Triple the speed when Shift is held
+// Blocks until an event arrives (or IDLE_WAIT_MS passes), then handles everything queued
+void wait_for_events() {
+    SDL_Event event;
+    if (SDL_WaitEventTimeout(&event, IDLE_WAIT_MS)) {
+        handle_event(&event);
+        process_input();
     }
+}
 
-    // Update ball position using delta_time
-    ball.x += ball.vx * ball_speed_multiplier * delta_time;
-    ball.y -= ball.vy * ball_speed_multiplier * delta_time;
-
-    // Increase block speed by adjusting block.vx
-    block.vx = 400.0f;  // Make block move faster (adjust value as needed)
-
-    // Adjust player speed when Shift is pressed
-    float speed_multiplier = 1.0f; // Default speed
-    if (key_state[SDL_SCANCODE_LSHIFT] || key_state[SDL_SCANCODE_RSHIFT]) {
-        speed_multiplier = 3.0f; // Triple the speed when Shift is held
-    }
 
-    // Continuous movement based on key state
-    if (key_state[SDL_SCANCODE_A]) {
-        block.x -= block.vx * speed_multiplier * delta_time;
+// Starts the sim thread on the game setup() just made, with a first snapshot for the render loop
+int start_simulation() {
+    sim_event = SDL_RegisterEvents(1);
+    if (inject_total > 0) {
+        inject_event = SDL_RegisterEvents(1);
     }
-    if (key_state[SDL_SCANCODE_D]) {
-        block.x += block.vx * speed_multiplier * delta_time;
+    sim_wake = SDL_CreateSemaphore(0);
+    if (!sim_wake) {
+        fprintf(stderr, "SDL_CreateSemaphore: %s\n", SDL_GetError());
+        return FALSE;
     }
 
-    // Ensure block / player stays within the window bounds
-    if (block.x < 0) {
-        block.x = 0;
-    }
-    if (block.x + block.width > WINDOW_WIDTH) {
-        block.x = WINDOW_WIDTH - block.width;
+    if (!snapshot_buffer_init(&snapshots, game.config.capacity)) {
+        return FALSE;
     }
+    snapshot_capture(&snapshots, &game, SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency());
+    view = snapshot_acquire(&snapshots);
 
-    // Ball boundary checks
-    if (ball.x < 0 || ball.x + ball.width > WINDOW_WIDTH) {
-        ball.vx *= -1; // Reverse horizontal velocity
-        if (ball.x < 0) ball.x = 0;
-        if (ball.x + ball.width > WINDOW_WIDTH) ball.x = WINDOW_WIDTH - ball.width;
-        /*  Check if the ball's right edge (ball.x + ball.width) exceeds the window's width (WINDOW_WIDTH).
-            If it does, reposition the ball so its right edge aligns exactly with the window boundary.
-            This prevents the ball from moving outside the visible area of the screen.
-        */
+    SDL_AtomicSet(&sim_running, TRUE);
+    sim_thread = SDL_CreateThread(simulate, "sim", NULL);
+    if (!sim_thread) {
+        fprintf(stderr, "SDL_CreateThread: %s\n", SDL_GetError());
+        return FALSE;
     }
+    return TRUE;
+}
 
-    if (ball.y < 0 || ball.y + ball.height > WINDOW_HEIGHT) {
-        ball.vy *= -1; // Reverse vertical velocity
-        if (ball.y < 0) ball.y = 0;
-        if (ball.y + ball.height > WINDOW_HEIGHT) ball.y = WINDOW_HEIGHT - ball.height;
-        /*  Check if the ball's top edge (ball.y) or bottom edge (ball.y + ball.height) exceeds the window's boundaries.
-            If the top edge goes above 0, reposition the ball so its top edge aligns with the top boundary.
-            If the bottom edge exceeds the window height (WINDOW_HEIGHT), reposition the ball so its bottom edge aligns with the bottom boundary.
-            This prevents the ball from moving outside the visible area of the screen.
-        */
+void stop_simulation() {
+    if (sim_thread) {
+        SDL_AtomicSet(&sim_running, FALSE);
+        SDL_SemPost(sim_wake);
+        SDL_WaitThread(sim_thread, NULL);
+        sim_thread = NULL;
     }
+    if (sim_wake) {
+        SDL_DestroySemaphore(sim_wake);
+        sim_wake = NULL;
+    }
+    view = NULL;
+    snapshot_buffer_free(&snapshots);
+}
 
-    // Update ball position using delta_time
-    //block.x += block.vx * delta_time;
-    //block.y -= block.vy * delta_time;
+// Sim thread: runs the fixed ticks at their own pace, so a slow present or a vsync wait
+// doesn't hold them up, and publishes a snapshot after every batch
+int simulate(void* data) {
+    (void)data;
+    profiler_set_track(PROFILER_TRACK_SIM);
+
+    const double sim_dt = 1.0 / sim_hz;
+    const double counter_frequency = (double)SDL_GetPerformanceFrequency();
+    Uint64 previous_counter = SDL_GetPerformanceCounter();
+    double accumulator = 0.0;
+    unsigned int tick = 0;
+
+    while (SDL_AtomicGet(&sim_running)) {
+        // Check for restart
+        if (SDL_AtomicSet(&sim_restart, 0) && game.is_game_over) {
+            reset_game(&game);
+
+            // A new game, rewinding mustn't take it back into the one that just ended
+            if (history.memory) {
+                rewind_clear(&history);
+            }
+            snapshot_capture(&snapshots, &game, SDL_GetPerformanceCounter() / counter_frequency);
+            wake_renderer();
+        }
 
-    // Block boundary checks
-    if (block.x < 0 || block.x + block.width > WINDOW_WIDTH) {
-        //block.vx *= -1; // Reverse horizontal velocity
-        if (block.x < 0) block.x = 0;
-        if (block.x + block.width > WINDOW_WIDTH) block.x = WINDOW_WIDTH - block.width;
-    }
+        // Back REWIND_SECONDS, or as far as the history goes
+        if (SDL_AtomicSet(&sim_rewind, 0) && history.memory) {
+            long restored = rewind_restore(&history, &game, REWIND_SECONDS * sim_hz);
+            if (restored >= 0) {
+                tick = (unsigned int)restored + 1;
+                store_previous_state(&game);
+                snapshot_capture(&snapshots, &game, SDL_GetPerformanceCounter() / counter_frequency);
+                wake_renderer();
+            }
+        }
 
-    if (block.y < 0 || block.y + block.height > WINDOW_HEIGHT) {
-        //block.vy *= -1; // Reverse vertical velocity
-        if (block.y < 0) block.y = 0;
-        if (block.y + block.height > WINDOW_HEIGHT) block.y = WINDOW_HEIGHT - block.height;
-    }
+        // A replay restarts right away, the recording didn't tick while the game over screen was up
+        if (game.is_game_over && replay_path) {
+            reset_game(&game);
+        }
+
+        // Level completed, continue to next level
+        if (game.level_complete) {
+            game.level_complete = 0;
+            accumulator = 0.0;
+        }
 
-    // Collision detection between the ball and the block
-    SDL_Rect ball_rect = { (int)ball.x, (int)ball.y, (int)ball.width, (int)ball.height };
-    SDL_Rect block_rect = { (int)block.x, (int)block.y, (int)block.width, (int)block.height };
-    SDL_Rect ground_rect = { (int)ground.x, (int)ground.y, (int)ground.width, (int)ground.height };
+        // Game over or paused: nothing to do until the render thread posts sim_wake
+        if (game.is_game_over || SDL_AtomicGet(&sim_paused)) {
+            SDL_SemWaitTimeout(sim_wake, IDLE_WAIT_MS);
+            previous_counter = SDL_GetPerformanceCounter();
+            accumulator = 0.0;
+            continue;
+        }
 
-    if (check_collision(ball_rect, block_rect)) {
-        // Determine the collision direction
-        float overlapLeft = (ball.x + ball.width) - block.x;
-        float overlapRight = (block.x + block.width) - ball.x;
-        float overlapTop = (ball.y + ball.height) - block.y;
-        float overlapBottom = (block.y + block.height) - ball.y;
+        Uint64 counter = SDL_GetPerformanceCounter();
+        double frame_time = (counter - previous_counter) / counter_frequency;
+        previous_counter = counter;
 
-        // Find the smallest overlap to determine the side of the collision
-        float minOverlapX = (overlapLeft < overlapRight) ? overlapLeft : overlapRight;
-        float minOverlapY = (overlapTop < overlapBottom) ? overlapTop : overlapBottom;
+        // Avoid a spiral of catch-up ticks after a stall (window drag, breakpoint, ...)
+        if (frame_time > MAX_FRAME_TIME) {
+            frame_time = MAX_FRAME_TIME;
+        }
 
-        if (minOverlapX < minOverlapY) {
-            // Horizontal collision
-            ball.vx *= -1; // Reverse horizontal velocity
-            if (overlapLeft < overlapRight) {
-                ball.x = block.x - ball.width; // Reposition to the left of the block
-            }
-            else {
-                ball.x = block.x + block.width; // Reposition to the right of the block
+        int ticked = 0;
+        if (replay_path) {
+            // Replays run at full speed, a frame's worth of ticks between snapshots
+            int ticks = sim_hz / FPS > 0 ? sim_hz / FPS : 1;
+            for (int t = 0; t < ticks; t++) {
+                unsigned int input;
+                if (!replay_next(&replay, &input)) {
+                    SDL_AtomicSet(&sim_done, TRUE);
+                    wake_renderer();
+                    return 0;
+                }
+
+                PROFILE_BEGIN(PROF_UPDATE);
+                store_previous_state(&game);
+                update(&game, input, (float)sim_dt);
+                PROFILE_END(PROF_UPDATE);
+                replay_check(&replay, game_checksum(&game));
+                ticked++;
+
+                if (game.is_game_over || game.level_complete) {
+                    break;
+                }
             }
         }
         else {
-            // Vertical collision
-            ball.vy *= -1; // Reverse vertical velocity
-            if (overlapTop < overlapBottom) {
-                ball.y = block.y - ball.height; // Reposition above the block
-            }
-            else {
-                ball.y = block.y + block.height; // Reposition below the block
+            // Run as many fixed ticks as the elapsed time allows. The probe is read first, so the
+            // buttons are at least as new as the input it stands for.
+            unsigned int probe = (unsigned int)SDL_AtomicGet(&sim_probe);
+            unsigned int input = (unsigned int)SDL_AtomicGet(&sim_input);
+            accumulator += frame_time;
+            while (accumulator >= sim_dt) {
+                PROFILE_BEGIN(PROF_UPDATE);
+                store_previous_state(&game);
+                update(&game, input, (float)sim_dt);
+                PROFILE_END(PROF_UPDATE);
+                accumulator -= sim_dt;
+                ticked++;
+
+                // First tick with a new steering change, for the latency mode
+                if (probe != snapshots.input_probe) {
+                    snapshots.input_probe = probe;
+                    snapshots.input_probe_time = SDL_GetPerformanceCounter() / counter_frequency;
+                }
+
+                if (record_path) {
+                    replay_record(&replay, input, game_checksum(&game));
+                }
+                if (history.memory) {
+                    rewind_record(&history, &game, tick);
+                }
+                tick++;
+
+                if (game.is_game_over || game.level_complete) {
+                    break;
+                }
             }
         }
-    }
-    if (check_collision(ball_rect, ground_rect)) {
-        is_game_over = 1;
-        //ball.vy *= -1; // Reverse vertical velocity
-        ball.y = ground.y - ball.height; // Align the ball above the ground
-    }
-
-    //printf("Total Objects: %d\n", total_objects_to_collect); 
 
-    // Not able to fix the issue with total_objects_to_collect variable that kept crashing the program so introduced some patching techniques and a new variable called to_collect instead
+        // Stamped with when the last tick was due, so the render thread can blend past it
+        if (ticked) {
+            snapshot_capture(&snapshots, &game, counter / counter_frequency - accumulator);
+        }
 
-    if (total_objects_to_collect > NUM_OBJECTS) {
-        total_objects_to_collect = NUM_OBJECTS;
+        // Sleep until the next tick is due
+        if (!replay_path && accumulator < sim_dt) {
+            SDL_Delay((Uint32)((sim_dt - accumulator) * 1000.0));
+        }
     }
+    return 0;
+}
 
-    //total_objects_to_collect = 10 + (current_level * 2);
-
-    // Update objects and check collisions
-    for (int i = 0; i < total_objects_to_collect; i++) {
-        if (!objects[i].is_active) continue;
+// Gets the render loop out of SDL_WaitEventTimeout
+void wake_renderer() {
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = sim_event;
+    SDL_PushEvent(&event);
+}
 
-        objects[i].speedY += objects[i].gravity;
-        objects[i].y += objects[i].speedY;
+// Starts bursts for the events of a snapshot we haven't seen, then moves every particle
+void update_particles(Uint64 now) {
+    PROFILE_BEGIN(PROF_PARTICLES);
 
-        // Collision with ball
-        SDL_Rect object_rect = { (int)objects[i].x, (int)objects[i].y, (int)objects[i].width, (int)objects[i].height };
-        //SDL_Rect ball_rect = { (int)ball.x, (int)ball.y, (int)ball.width, (int)ball.height };
+    if (view->serial != particle_serial) {
+        particle_serial = view->serial;
+        scene_emit_particles(&particles, view->events, view->num_events);
+    }
 
-        if (check_collision(ball_rect, object_rect)) {
-            objects[i].is_active = 0; // Make the object disappear
-            collected_objects++; // Increment collected objects
-        }
+    // A long frame (dragging the window, a breakpoint) shouldn't fling them off screen
+    float dt = 0.0f;
+    if (particle_counter != 0) {
+        dt = (float)((now - particle_counter) / (double)SDL_GetPerformanceFrequency());
+        if (dt > 0.1f) dt = 0.1f;
+    }
+    particle_counter = now;
+    particles_update(&particles, dt);
 
-        if (check_collision(block_rect, object_rect)) {
-            if (objects[i].is_active) {  // Only end game for active objects
-                is_game_over = 1;
-                printf("Game over due to block-object collision\n");
-            }
-        }
+    PROFILE_END(PROF_PARTICLES);
+}
 
-        // Reset object if it hits the ground
-        if (objects[i].y + objects[i].height > ground.y) {
-            initializeObject(&objects[i]);
-            objects[i].is_active = 1;
-        }
-    }
+// Samples the keyboard into the INPUT_* buttons used by update()
+unsigned int read_input() {
+    const Uint8* key_state = SDL_GetKeyboardState(NULL);
+    unsigned int input = injected_input;
 
-    if (is_game_over) {
-        printf("Game Over\n");
-        return;
-        //renderGameOverScreen(renderer);
-        //game_is_running = 0; // End the game loop
-    }
+    if (key_state[SDL_SCANCODE_A]) input |= INPUT_LEFT;
+    if (key_state[SDL_SCANCODE_D]) input |= INPUT_RIGHT;
+    if (key_state[SDL_SCANCODE_LSHIFT] || key_state[SDL_SCANCODE_RSHIFT]) input |= INPUT_FAST;
+    if (key_state[SDL_SCANCODE_SPACE]) input |= INPUT_BOOST;
 
-    if (collected_objects >= to_collect) {
-        is_game_over = 0;
-        current_level++;
-        level_complete = 1;
+    return input;
+}
 
-        // Increase difficulty
-        increase_level_difficulty();
 
-        // Reset game state for next level
-        setup();
-        printf("Collected Objects: %d, Total Objects: %d\n", collected_objects, total_objects_to_collect);
-        printf("Level completed! Moving to Level %d\n", current_level);
-        return;
+// Latency mode without a player: steers right, lets go, steers left, lets go, at uneven gaps,
+// and quits once every change made it to the screen
+void inject_input() {
+    double now = counter_seconds();
+    if (injected < inject_total && now >= next_inject) {
+        static const unsigned int steps[4] = { INPUT_RIGHT, 0, INPUT_LEFT, 0 };
+        SDL_Event event;
+        memset(&event, 0, sizeof(event));
+        event.type = inject_event;
+        event.user.code = (Sint32)steps[injected % 4];
+        SDL_PushEvent(&event);
+
+        injected++;
+        next_inject = now + rng_range(&inject_rng, (float)INJECT_MIN_GAP, (float)INJECT_MAX_GAP);
     }
 
-    // Forced object generation if not enough objects are active
-    int active_objects_count = 0;
-    for (int i = 0; i < total_objects_to_collect; i++) {
-        if (objects[i].is_active) {
-            active_objects_count++;
-        }
+    // Nobody presses Enter, start over like a replay does
+    if (view->is_game_over) {
+        SDL_AtomicSet(&sim_restart, 1);
+        SDL_SemPost(sim_wake);
     }
 
-    // If not enough active objects, generate more
-    if (active_objects_count < total_objects_to_collect) {
-        for (int i = 0; i < total_objects_to_collect; i++) {
-            if (!objects[i].is_active) {
-                initializeObject(&objects[i]);
-                objects[i].is_active = 1;
-
-                // Ensure unique positioning
-                objects[i].x = rand() % (WINDOW_WIDTH - objects[i].width);
-                objects[i].y = -100 - (i * 50);
-            }
-        }
+    if (injected == inject_total && (latency.num_pending == 0 || now > next_inject + INJECT_TIMEOUT)) {
+        game_is_running = FALSE;
     }
+}
 
-    // Cap the frame rate using SDL_Delay
-    int delay_time = (last_frame_time + FRAME_TARGET_TIME) - SDL_GetTicks();
-    if (delay_time > 0) {
-        SDL_Delay(delay_time);
-    }
+// Seconds on the performance counter, the clock the snapshots are stamped with
+double counter_seconds() {
+    return SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
 }
 
+// Draws the newest snapshot, alpha is how far we are between its previous and its last sim tick (0..1)
+void render(float alpha) {
+    PROFILE_BEGIN(PROF_RENDER);
 
-void render() {
     //SDL_SetRenderDrawColor(renderer, 0, 75, 35, 255);
     //SDL_RenderClear(renderer);
 
-    SDL_RenderCopy(renderer, background, NULL, NULL);
-
-    // Draw a ball rect
-    SDL_Rect ball_rect = {
-        (int)ball.x,
-        (int)ball.y,
-        (int)ball.width,
-        (int)ball.height
-    };
-    SDL_RenderCopy(renderer, ball_texture, NULL, &ball_rect);
-    //SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    //SDL_RenderFillRect(renderer, &ball_rect); 
-
-    // Draw a block rect
-    SDL_Rect block_rect = {
-        (int)block.x,
-        (int)block.y,
-        (int)block.width,
-        (int)block.height
-    };
-    SDL_RenderCopy(renderer, block_texture, NULL, &block_rect);
-    //SDL_SetRenderDrawColor(renderer, 145, 32, 22, 255);
-    //SDL_RenderFillRect(renderer, &block_rect);
-
-    // Draw Ground Rect
-    SDL_Rect ground_rect = {
-        (int)ground.x,
-        (int)ground.y,
-        (int)ground.width,
-        (int)ground.height
-    };
+    // The whole scene is one batch out of the sprite atlas, drawn back to front into the offscreen target
+    display_begin_scene(renderer);
+    sprites_begin();
+    scene_draw_world(&canvas, view, alpha, &particles);
+    sprites_flush(renderer);
 
-    SDL_SetRenderDrawColor(renderer, 135, 42, 32, 255);
-    SDL_RenderFillRect(renderer, &ground_rect);
+    // Scene upscaled to the window, the HUD goes on top at the window's resolution
+    display_end_scene(renderer);
+    scene_draw_hud(&canvas, view);
 
-    for (int i = 0; i < NUM_OBJECTS; i++) {
-        if(objects[i].is_active){
-        SDL_Rect obj_rect = {
-            (int)objects[i].x,
-            (int)objects[i].y,
-            objects[i].width,
-            objects[i].height
-        };
-        SDL_RenderCopy(renderer, object_texture, NULL, &obj_rect);
-        //SDL_RenderFillRect(renderer, &obj_rect);
-        }
+    if (show_profiler) {
+        renderProfilerOverlay(renderer);
     }
+    if (paused) {
+        scene_draw_paused(&canvas);
+    }
+    PROFILE_END(PROF_RENDER);
 
-    // Render level and collected objects information
-    char level_text[50];
-    char objects_text[50];
-
-    snprintf(level_text, sizeof(level_text), "LEVEL: %d", current_level);
-    snprintf(objects_text, sizeof(objects_text), "EGGS: %d/%d", collected_objects, to_collect);
+    PROFILE_BEGIN(PROF_PRESENT);
+    submit_time = counter_seconds();
+    SDL_RenderPresent(renderer); // For Buffer Swap
+    present_time = counter_seconds();
+    PROFILE_END(PROF_PRESENT);
+}
 
-    renderTextWithFont(
-        renderer,
-        "assets/Pixeltype.ttf",
-        level_text,
-        90, 50, 255, 255, 255, 24
-    );
+// Refresh rate of the screen the window is on, FPS when SDL doesn't know it
+double refresh_rate() {
+    SDL_DisplayMode mode;
+    int display = SDL_GetWindowDisplayIndex(window);
+    if (display >= 0 && SDL_GetCurrentDisplayMode(display, &mode) == 0 && mode.refresh_rate > 0) {
+        return mode.refresh_rate;
+    }
+    return FPS;
+}
 
-    renderTextWithFont(
-        renderer,
-        "assets/Pixeltype.ttf",
-        objects_text,
-        100, 80, 255, 255, 255, 24
-    );
+// Turns vsync on or off when the pacer changes its mind (adaptive mode), and once at startup
+void apply_vsync() {
+    int vsync = pacer_wants_vsync(&pacer);
+    if (vsync == vsync_applied) {
+        return;
+    }
 
-    SDL_RenderPresent(renderer); // For Buffer Swap
+    // Some renderers can't switch it, the pacer caps in software then
+    if (SDL_RenderSetVSync(renderer, vsync) != 0) {
+        printf("SDL_RenderSetVSync: %s\n", SDL_GetError());
+        if (vsync) pacer.vsync_broken = TRUE;
+    }
+    vsync_applied = vsync;
 }
 
 void destroy_window() {
-    SDL_DestroyTexture(ball_texture);
-    SDL_DestroyTexture(block_texture);
-    SDL_DestroyTexture(object_texture);
-    SDL_DestroyTexture(background);
+    display_shutdown();
+    sprites_shutdown();
+    text_shutdown();
+    resource_shutdown();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     TTF_Quit();
@@ -700,133 +983,149 @@ void destroy_window() {
 
 /* Functionalities */
 
-bool check_collision(SDL_Rect a, SDL_Rect b) {
-    // Check if there is a gap between the two rectangles
-    if (a.x + a.w <= b.x || // a is to the left of b
-        a.x >= b.x + b.w || // a is to the right of b
-        a.y + a.h <= b.y || // a is above b
-        a.y >= b.y + b.h) { // a is below b
-        return false; // No collision
-    }
-    return true; // Collision detected
-}
+// Game Over Screen
 
-// Function to initialize an object
-void initializeObject(Object* obj) {
-    // Ensure obj is not NULL
-    if (obj == NULL) {
-        fprintf(stderr, "Error: Trying to initialize NULL object\n");
-        return;
-    }
+void renderGameOverScreen(SDL_Renderer* renderer) {
+    display_begin_scene(renderer);
+    sprites_begin();
+    scene_draw_background(&canvas);
+    sprites_flush(renderer);
+    display_end_scene(renderer);
 
-    // Add bounds checking
-    obj->x = rand() % (WINDOW_WIDTH - 20); // Ensure width is not exceeded
-    obj->y = -100;
-    obj->speedY = 0;
-    obj->gravity = (float)(rand() % 5 + 1) / 50.0f;
+    scene_draw_game_over(&canvas, view);
 
-    // Ensure consistent object dimensions
-    obj->width = 20;
-    obj->height = 20;
-    obj->is_active = 1;
+    SDL_RenderPresent(renderer);
 }
 
-// Game Over Screen
-
-void renderGameOverScreen(SDL_Renderer* renderer) {
-    SDL_RenderCopy(renderer, background, NULL, NULL);
+// Loading Screen
 
-    char game_over_text[100];
-    snprintf(game_over_text, sizeof(game_over_text), "GAME OVER - LEVEL %d", current_level);
+void renderLoadingScreen(SDL_Renderer* renderer, int done, int total) {
+    display_begin_hud(renderer);
 
-    // Game Over text with original font
     renderTextWithFont(
         renderer,
-        "assets/Pixeltype.ttf",
-        game_over_text,
+        TEXT_DEFAULT_FONT,
+        "LOADING",
         WINDOW_WIDTH / 2,
-        WINDOW_HEIGHT / 2 - 100,
+        WINDOW_HEIGHT / 2 - 40,
         255, 255, 255,
         36
     );
 
-    // Restart instructions with a different font
-    renderTextWithFont(
-        renderer,
-        "C:\\Users\\Paracite\\Desktop\\C Projects\\Project1\\Project1\\Minecraft.ttf",
-        "PRESS ENTER TO RESTART",
-        WINDOW_WIDTH / 2,
-        WINDOW_HEIGHT / 2 + 50,
-        200, 200, 200,
-        24
-    );
+    // Progress bar
+    SDL_Rect frame = { WINDOW_WIDTH / 2 - 150, WINDOW_HEIGHT / 2, 300, 20 };
+    SDL_Rect bar = { frame.x + 2, frame.y + 2, total > 0 ? (frame.w - 4) * done / total : 0, frame.h - 4 };
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDrawRect(renderer, &frame);
+    SDL_SetRenderDrawColor(renderer, 135, 42, 32, 255);
+    SDL_RenderFillRect(renderer, &bar);
 
     SDL_RenderPresent(renderer);
 }
 
-// Add a reset function to reinitialize game state
-void reset_game() {
-    // Reset level and object collection
-    current_level = 1;
-    total_objects_to_collect = NUM_OBJECTS;
-    collected_objects = 0;
-    to_collect = 10;
-
-    // Reset ball position and velocity
-    ball.x = 500;
-    ball.y = 500;
-    ball.vx = 200;
-    ball.vy = 150;
-
-    // Reset block position
-    block.x = 400;
-    block.y = WINDOW_HEIGHT - block.height - ground.height;
-
-    // Reset objects
-    for (int i = 0; i < total_objects_to_collect; i++) {
-        initializeObject(&objects[i]);
-    }
-
-    // Reset game state flags
-    is_game_over = 0;
-    restart_requested = 0;
-    level_complete = 0;
-}
+// Profiler Overlay
 
-void increase_level_difficulty() {
-    // Explicitly calculate objects based on current level
-    total_objects_to_collect = 10 + (current_level * 2);
+void renderProfilerOverlay(SDL_Renderer* renderer) {
+    static double p50[PROF_COUNT], p99[PROF_COUNT];
+    static int refresh = 0;
 
-    // Cap the maximum objects if needed
-    if (total_objects_to_collect > 20) {
-        total_objects_to_collect = 20;
+    // Percentiles sort the whole ring, twice a second is plenty
+    if (refresh-- <= 0) {
+        for (int p = 0; p < PROF_COUNT; p++) {
+            profiler_percentiles(p, &p50[p], &p99[p]);
+        }
+        refresh = FPS / 2;
     }
 
-    // Reset collected objects
-    collected_objects = 0;
-
-    // Reinitialize only the active objects needed for this level
-    for (int i = 0; i < NUM_OBJECTS; i++) {
-        if (i < total_objects_to_collect) {
-            initializeObject(&objects[i]);
-            objects[i].is_active = 1;
-
-            // Stagger starting heights
-            objects[i].x = rand() % (WINDOW_WIDTH - objects[i].width);
-            objects[i].y = -100 - (i * 50);
-
-            // Increase difficulty by increasing gravity more gradually
-            objects[i].gravity *= 1.1f;
+    const int graph_frames = 150;
+    const int ms_height = 3;    // Pixels per millisecond in the graph
+    SDL_Rect panel = { WINDOW_WIDTH - 330, 10, 320, 340 };
+    int graph_left = panel.x + 10;
+    int graph_bottom = panel.y + 90;
+    double budget_ms = pacer.interval * 1000.0;     // Red above it, the pacer's rate
+
+    sprites_begin();
+    sprites_fill(&panel, 20, 20, 20);
+
+    // Frame times, newest on the right, red when over the frame budget
+    for (int i = 0; i < graph_frames; i++) {
+        double ms = profiler_frame_ms(PROF_FRAME, i);
+        int height = (int)(ms * ms_height);
+        if (height > 80) height = 80;
+
+        SDL_Rect bar = { graph_left + (graph_frames - 1 - i) * 2, graph_bottom - height, 2, height };
+        if (ms > budget_ms + 1) {
+            sprites_fill(&bar, 220, 60, 50);
         }
         else {
-            objects[i].is_active = 0;
+            sprites_fill(&bar, 60, 200, 90);
         }
     }
 
-    // Gradually increase speeds
-    ball.vx *= 1.1f;
-    ball.vy *= 1.1f;
-    block.vx *= 1.1f;
+    SDL_Rect budget = { graph_left, graph_bottom - (int)(budget_ms * ms_height), graph_frames * 2, 1 };
+    sprites_fill(&budget, 255, 255, 255);
+    sprites_flush(renderer);
+
+    int y = graph_bottom + 20;
+    renderTextLeft(renderer, "PHASE", graph_left, y, 200, 200, 200);
+    renderTextLeft(renderer, "P50 MS", graph_left + 160, y, 200, 200, 200);
+    renderTextLeft(renderer, "P99 MS", graph_left + 235, y, 200, 200, 200);
+
+    for (int p = 0; p < PROF_COUNT; p++) {
+        char p50_text[16];
+        char p99_text[16];
+        snprintf(p50_text, sizeof(p50_text), "%.2f", p50[p]);
+        snprintf(p99_text, sizeof(p99_text), "%.2f", p99[p]);
+
+        y += 18;
+        renderTextLeft(renderer, profiler_phase_name(p), graph_left, y, 255, 255, 255);
+        renderTextLeft(renderer, p50_text, graph_left + 160, y, 255, 255, 255);
+        renderTextLeft(renderer, p99_text, graph_left + 235, y, 255, 255, 255);
+    }
+
+    // Resolution the scene is drawn at right now
+    char scale_text[48];
+    int scene_width, scene_height;
+    display_scene_size(&scene_width, &scene_height);
+    snprintf(scale_text, sizeof(scale_text), "SCALE %.2f (%dx%d)", display_scale(), scene_width, scene_height);
+    y += 18;
+    renderTextLeft(renderer, scale_text, graph_left, y, 200, 200, 200);
+
+    // Pacing mode, software cap or vsync, and how many frames were late
+    char pace_text[64];
+    snprintf(pace_text, sizeof(pace_text), "PACE %s %.0f HZ, %lu MISSED", pacer_mode_name(pacer.mode),
+        1.0 / pacer.interval, pacer.missed);
+    SDL_strupr(pace_text);
+    y += 18;
+    renderTextLeft(renderer, pace_text, graph_left, y, 200, 200, 200);
+}
+
+// Canvas
+
+void canvas_sprite(void* context, int sprite, const SceneRect* dst, SceneColor color, int flip_x) {
+    (void)context;
+    SDL_Color tint = { color.r, color.g, color.b, color.a };
+    if (!dst) {
+        sprites_draw_ex(sprite, NULL, tint, flip_x);
+        return;
+    }
+    SDL_Rect rect = { dst->x, dst->y, dst->w, dst->h };
+    sprites_draw_ex(sprite, &rect, tint, flip_x);
+}
+
+void canvas_fill(void* context, const SceneRect* dst, SceneColor color) {
+    (void)context;
+    SDL_Rect rect = { dst->x, dst->y, dst->w, dst->h };
+    sprites_fill(&rect, color.r, color.g, color.b);
+}
+
+void canvas_text(void* context, const char* font_path, int font_size, const char* text, int x, int y, SceneColor color) {
+    (void)context;
+    text_draw(renderer, font_path, font_size, text, x, y, color.r, color.g, color.b);
+}
 
-    printf("Level difficulty increased. New level: %d, Total objects: %d\n", current_level, total_objects_to_collect);
-}
\ No newline at end of file
+void canvas_sprite_size(void* context, int sprite, int* width, int* height) {
+    (void)context;
+    sprites_size(sprite, width, height);
+}
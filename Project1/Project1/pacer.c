@@ -0,0 +1,209 @@
+#define _CRT_SECURE_NO_WARNINGS
+#define _POSIX_C_SOURCE 199309L // clock_gettime, nanosleep
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Other_includes
+#include "constants.h"
+#include "pacer.h"
+
+#ifdef _WIN32
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+static const char* mode_names[PACE_MODES] = { "vsync", "adaptive", "uncapped", "cap" };
+
+double pacer_now() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void sleep_seconds(double seconds) {
+#ifdef _WIN32
+    // A high resolution timer wakes within a fraction of a millisecond (Windows 10 1803 and up),
+    // plain Sleep() rounds to the system timer tick
+    static HANDLE timer = NULL;
+    static int timer_tried = FALSE;
+    if (!timer_tried) {
+        timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        timer_tried = TRUE;
+    }
+    if (timer) {
+        LARGE_INTEGER due;
+        due.QuadPart = -(LONGLONG)(seconds * 1e7);  // Relative, in 100 ns units
+        if (SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE)) {
+            WaitForSingleObject(timer, INFINITE);
+            return;
+        }
+    }
+    Sleep((DWORD)(seconds * 1000.0));
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+#endif
+}
+
+// Sleeps most of the way, then spins so the wakeup lands on the deadline
+static void wait_until(Pacer* pacer, double deadline) {
+    double remaining = deadline - pacer_now();
+    if (remaining > pacer->spin) {
+        double request = remaining - pacer->spin;
+        double before = pacer_now();
+        sleep_seconds(request);
+        double overshoot = pacer_now() - before - request;
+
+        // Jumps up to the worst overshoot, eases back down slowly
+        double spin = pacer->spin - (pacer->spin - PACER_MIN_SPIN) * 0.02;
+        if (overshoot + PACER_MIN_SPIN > spin) spin = overshoot + PACER_MIN_SPIN;
+        if (spin > PACER_MAX_SPIN) spin = PACER_MAX_SPIN;
+        pacer->spin = spin;
+    }
+
+    while (pacer_now() < deadline) {
+        // Spin
+    }
+}
+
+// Modes that wait in pacer_frame_end() instead of in the present
+static int software_cap(const Pacer* pacer) {
+    if (pacer->mode == PACE_CAP) return TRUE;
+    if (pacer->mode == PACE_UNCAPPED) return FALSE;
+    return !pacer->vsync || pacer->vsync_broken;
+}
+
+void pacer_init(Pacer* pacer, int mode, double hz) {
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->mode = (mode >= 0 && mode < PACE_MODES) ? mode : PACE_VSYNC;
+    pacer->spin = 0.001;
+    pacer->vsync = pacer->mode == PACE_VSYNC || pacer->mode == PACE_ADAPTIVE;
+    pacer_set_rate(pacer, hz);
+}
+
+void pacer_set_rate(Pacer* pacer, double hz) {
+    if (hz <= 0.0) hz = FPS;
+    pacer->interval = 1.0 / hz;
+    pacer->deadline = 0.0;
+    pacer->fast_streak = 0;
+}
+
+void pacer_resume(Pacer* pacer) {
+    pacer->frame_start = 0.0;
+    pacer->deadline = 0.0;
+    pacer->fast_streak = 0;
+}
+
+void pacer_frame_end(Pacer* pacer) {
+    double now = pacer_now();
+    double frame_time = pacer->frame_start > 0.0 ? now - pacer->frame_start : 0.0;
+    int missed = FALSE;
+    int comfortable = FALSE;
+
+    if (software_cap(pacer)) {
+        if (pacer->deadline == 0.0) {
+            pacer->deadline = now + pacer->interval;
+        }
+
+        if (now > pacer->deadline) {
+            // Late: start over from here instead of rushing the next frames to catch up
+            missed = TRUE;
+            pacer->deadline = now + pacer->interval;
+        }
+        else {
+            comfortable = pacer->deadline - now > pacer->interval * 0.1;
+            wait_until(pacer, pacer->deadline);
+            pacer->deadline += pacer->interval;
+        }
+    }
+    else if (pacer->vsync && pacer->frame_start > 0.0) {
+        missed = frame_time >= pacer->interval * PACER_MISS_PERIODS;
+        comfortable = !missed;
+
+        // Presents that return much faster than the display refreshes aren't waiting for it
+        pacer->fast_streak = frame_time < pacer->interval * 0.5 ? pacer->fast_streak + 1 : 0;
+        if (pacer->fast_streak >= PACER_VSYNC_BROKEN_FRAMES) {
+            printf("Pacer: presents don't wait for vsync, capping at %.0f Hz instead\n", 1.0 / pacer->interval);
+            pacer->vsync_broken = TRUE;
+            pacer->deadline = 0.0;
+        }
+    }
+
+    // Adaptive: tear rather than drop to half rate while frames miss, sync again once they fit
+    if (pacer->mode == PACE_ADAPTIVE) {
+        if (missed) {
+            pacer->good_streak = 0;
+            if (++pacer->miss_streak >= PACER_ADAPTIVE_MISSES && pacer->vsync) {
+                pacer->vsync = FALSE;
+                pacer->deadline = 0.0;
+            }
+        }
+        else {
+            pacer->miss_streak = 0;
+            pacer->good_streak = comfortable ? pacer->good_streak + 1 : 0;
+            if (!pacer->vsync && pacer->good_streak >= PACER_ADAPTIVE_RECOVER) {
+                pacer->vsync = TRUE;
+                pacer->good_streak = 0;
+            }
+        }
+    }
+
+    pacer->last_missed = missed;
+    pacer->missed += missed;
+
+    // Stats take the whole frame, waiting included
+    double end = pacer_now();
+    if (pacer->frame_start > 0.0) {
+        double frame = end - pacer->frame_start;
+        pacer->frames++;
+        double delta = frame - pacer->mean;
+        pacer->mean += delta / pacer->frames;
+        pacer->m2 += delta * (frame - pacer->mean);
+        if (frame > pacer->worst) pacer->worst = frame;
+    }
+    pacer->frame_start = end;
+}
+
+int pacer_wants_vsync(const Pacer* pacer) {
+    return pacer->mode != PACE_CAP && pacer->mode != PACE_UNCAPPED && pacer->vsync;
+}
+
+void pacer_stats(const Pacer* pacer, double* mean_ms, double* jitter_ms, double* worst_ms) {
+    if (mean_ms) *mean_ms = pacer->mean * 1000.0;
+    if (jitter_ms) *jitter_ms = pacer->frames > 1 ? sqrt(pacer->m2 / (pacer->frames - 1)) * 1000.0 : 0.0;
+    if (worst_ms) *worst_ms = pacer->worst * 1000.0;
+}
+
+const char* pacer_mode_name(int mode) {
+    return (mode >= 0 && mode < PACE_MODES) ? mode_names[mode] : "?";
+}
+
+int pacer_mode_from_name(const char* name) {
+    for (int i = 0; i < PACE_MODES; i++) {
+        if (strcmp(name, mode_names[i]) == 0) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+// Frame pacing for the render loop. No SDL in here, so bench can measure how steady it is.
+// The caller presents, then calls pacer_frame_end(), which waits if the mode needs it and keeps
+// the stats. vsync itself is the renderer's job: the caller applies pacer_wants_vsync().
+//
+// PACE_CAP sleeps until just before the deadline and spins on the clock for the rest. Sleeps
+// overshoot by a different amount on every OS, so the spin window follows the worst overshoot
+// seen lately. Deadlines step by a fixed interval from the last one, not from when the frame
+// ended, so the rate doesn't drift by the wakeup error every frame.
+
+// Modes
+enum {
+    PACE_VSYNC,     // Present waits for the display, a late frame waits for the next refresh
+    PACE_ADAPTIVE,  // vsync while frames keep up, off (tearing, capped in software) while they miss
+    PACE_UNCAPPED,  // As fast as it goes
+    PACE_CAP,       // Software cap at a fixed rate, no vsync
+    PACE_MODES
+};
+
+// A vsync frame counts as missed when it took this many refresh periods or more
+#define PACER_MISS_PERIODS 1.5
+
+// PACE_ADAPTIVE turns vsync off after this many misses in a row, back on after this many good frames
+#define PACER_ADAPTIVE_MISSES 2
+#define PACER_ADAPTIVE_RECOVER 120
+
+// Frames in a row well under a refresh period before vsync is taken as not working
+#define PACER_VSYNC_BROKEN_FRAMES 60
+
+// Spin window bounds, seconds
+#define PACER_MIN_SPIN 0.0002
+#define PACER_MAX_SPIN 0.004
+
+typedef struct {
+    int mode;
+    double interval;        // Seconds per frame: the cap rate, or the refresh period with vsync
+    double deadline;        // When the current frame should be done, 0 before the first frame
+    double frame_start;     // When the last pacer_frame_end() returned
+    double spin;            // Sleeping stops this long before the deadline
+
+    int vsync;              // What the renderer should be set to
+    int vsync_broken;       // Presents don't block, so vsync modes cap in software instead
+    int miss_streak;
+    int good_streak;
+    int fast_streak;
+    int last_missed;        // The frame that just ended
+
+    // Stats since pacer_init(), frame time is from one pacer_frame_end() to the next
+    unsigned long frames;
+    unsigned long missed;
+    double mean;            // Seconds, running mean and squared deviations (Welford)
+    double m2;
+    double worst;
+} Pacer;
+
+// hz is the cap rate for PACE_CAP and the display's refresh rate for the rest
+void pacer_init(Pacer* pacer, int mode, double hz);
+
+// The display changed, the stats carry on
+void pacer_set_rate(Pacer* pacer, double hz);
+
+// After a pause or a static screen, so the wait doesn't count as a frame
+void pacer_resume(Pacer* pacer);
+
+// Call right after presenting. Waits out the rest of the frame when the mode caps in software.
+void pacer_frame_end(Pacer* pacer);
+
+int pacer_wants_vsync(const Pacer* pacer);
+
+// Mean frame time, standard deviation and the longest frame, in milliseconds
+void pacer_stats(const Pacer* pacer, double* mean_ms, double* jitter_ms, double* worst_ms);
+
+// Monotonic clock in seconds
+double pacer_now();
+
+const char* pacer_mode_name(int mode);
+int pacer_mode_from_name(const char* name);   // -1 if unknown
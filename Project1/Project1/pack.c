@@ -0,0 +1,164 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Asset packer: decodes the PNGs once, offline, and writes them as RGBA pixels into
+// an archive the game memory-maps at startup (see archive.h). Run it from this folder
+// whenever an image changes, the game falls back to the PNGs for anything missing.
+//
+// Usage: pack [--out FILE] [image.png ...]
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// User_defined_library
+#include <SDL.h>
+#include <SDL_image.h>
+
+// Other_includes
+#include "constants.h"
+#include "archive.h"
+#include "assets.h"
+
+#define MAX_FILES 64
+
+static double elapsed_ms(Uint64 start) {
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+static uint64_t align(uint64_t offset) {
+    return (offset + ARCHIVE_ALIGN - 1) & ~(uint64_t)(ARCHIVE_ALIGN - 1);
+}
+
+static int write_padding(FILE* file, uint64_t from, uint64_t to) {
+    static const unsigned char zeros[ARCHIVE_ALIGN] = { 0 };
+    return to == from || fwrite(zeros, 1, (size_t)(to - from), file) == to - from;
+}
+
+int main(int argc, char* argv[]) {
+    const char* out_path = ASSET_ARCHIVE;
+    const char* files[MAX_FILES];
+    int num_files = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        }
+        else if (num_files < MAX_FILES) {
+            files[num_files++] = argv[i];
+        }
+    }
+    // Every sprite the game loads from a file, straight from its own list
+    if (num_files == 0) {
+        for (int i = 0; i < SPRITE_COUNT; i++) {
+            if (assets_sprite_file(i)) {
+                files[num_files++] = assets_sprite_file(i);
+            }
+        }
+    }
+
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        fprintf(stderr, "Error Initializing SDL_image: %s\n", IMG_GetError());
+        return 1;
+    }
+
+    // Decode everything first, this is the cost the archive saves at startup
+    SDL_Surface* surfaces[MAX_FILES];
+    Uint64 decode_start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < num_files; i++) {
+        SDL_Surface* loaded = IMG_Load(files[i]);
+        if (!loaded) {
+            fprintf(stderr, "Error loading image: %s\n", IMG_GetError());
+            return 1;
+        }
+        surfaces[i] = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+        if (!surfaces[i]) {
+            fprintf(stderr, "SDL_ConvertSurfaceFormat: %s\n", SDL_GetError());
+            return 1;
+        }
+    }
+    double decode_ms = elapsed_ms(decode_start);
+
+    // Index first, then the pixels, tightly packed rows
+    ArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARCHIVE_MAGIC, 4);
+    header.version = ARCHIVE_VERSION;
+    header.count = (uint32_t)num_files;
+
+    ArchiveEntry entries[MAX_FILES];
+    memset(entries, 0, sizeof(entries));
+    uint64_t offset = align(sizeof(ArchiveHeader) + sizeof(ArchiveEntry) * (uint64_t)num_files);
+    for (int i = 0; i < num_files; i++) {
+        if (strlen(files[i]) >= ARCHIVE_NAME_LENGTH) {
+            fprintf(stderr, "Name too long for the archive: %s\n", files[i]);
+            return 1;
+        }
+        snprintf(entries[i].name, sizeof(entries[i].name), "%s", files[i]);
+        entries[i].width = (uint32_t)surfaces[i]->w;
+        entries[i].height = (uint32_t)surfaces[i]->h;
+        entries[i].pitch = entries[i].width * 4;
+        entries[i].format = SDL_PIXELFORMAT_RGBA32;
+        entries[i].offset = offset;
+        entries[i].size = (uint64_t)entries[i].pitch * entries[i].height;
+        offset = align(offset + entries[i].size);
+    }
+
+    FILE* file = fopen(out_path, "wb");
+    if (!file) {
+        fprintf(stderr, "Can't write %s\n", out_path);
+        return 1;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(entries, sizeof(ArchiveEntry), (size_t)num_files, file) == (size_t)num_files;
+    uint64_t written = sizeof(header) + sizeof(ArchiveEntry) * (uint64_t)num_files;
+
+    for (int i = 0; i < num_files && ok; i++) {
+        ok = write_padding(file, written, entries[i].offset);
+        written = entries[i].offset;
+
+        const unsigned char* row = surfaces[i]->pixels;
+        for (uint32_t y = 0; y < entries[i].height && ok; y++) {
+            ok = fwrite(row, 1, entries[i].pitch, file) == entries[i].pitch;
+            row += surfaces[i]->pitch;
+        }
+        written += entries[i].size;
+    }
+    ok = ok && write_padding(file, written, offset);
+    ok = fclose(file) == 0 && ok;
+
+    for (int i = 0; i < num_files; i++) {
+        SDL_FreeSurface(surfaces[i]);
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Error writing %s\n", out_path);
+        return 1;
+    }
+
+    // Read it back the way the game does, touching every pixel like the texture upload would
+    Uint64 map_start = SDL_GetPerformanceCounter();
+    Archive archive;
+    if (!archive_open(&archive, out_path)) {
+        fprintf(stderr, "Error reading back %s\n", out_path);
+        return 1;
+    }
+    unsigned int checksum = 0;
+    for (int i = 0; i < num_files; i++) {
+        const ArchiveEntry* entry = archive_find(&archive, files[i]);
+        const unsigned char* pixels = archive_pixels(&archive, entry);
+        for (uint64_t b = 0; b < entry->size; b += 64) {
+            checksum += pixels[b];
+        }
+    }
+    archive_close(&archive);
+    double map_ms = elapsed_ms(map_start);
+
+    printf("Packed %d images into %s, %.1f KB\n", num_files, out_path, offset / 1024.0);
+    printf("PNG decode: %.2f ms, archive map: %.2f ms (checksum %u)\n", decode_ms, map_ms, checksum);
+
+    IMG_Quit();
+    return 0;
+}
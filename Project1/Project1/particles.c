@@ -0,0 +1,143 @@
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+// Other_includes
+#include "constants.h"
+#include "particles.h"
+
+// Float arrays per particle, kind comes after them
+#define PARTICLE_ARRAYS 8
+#define PI 3.14159265f
+
+// How each kind of burst looks
+typedef struct {
+    float angle_min, angle_max; // Radians, 0 points right and y grows downwards
+    float speed_min, speed_max;
+    float gravity;
+    float life_min, life_max;
+    float size_min, size_max;
+} BurstStyle;
+
+static const BurstStyle styles[PARTICLE_KINDS] = {
+    // Shell bits fly up and out of the splat and fall back down
+    { -PI * 0.85f, -PI * 0.15f, 80.0f, 260.0f, 900.0f, 0.5f, 0.9f, 14.0f, 26.0f },
+    // Sparkles go every way and drift up
+    { -PI, PI, 40.0f, 160.0f, -60.0f, 0.4f, 0.8f, 6.0f, 12.0f },
+};
+
+int particles_init(Particles* particles, int capacity) {
+    memset(particles, 0, sizeof(*particles));
+
+    // Round up to a power of two so ring positions wrap with a mask
+    int rounded = 1;
+    while (rounded < capacity) rounded *= 2;
+    capacity = rounded;
+
+    particles->memory = malloc((sizeof(float) * PARTICLE_ARRAYS + sizeof(unsigned char)) * capacity);
+    if (!particles->memory) {
+        fprintf(stderr, "Error: Could not allocate %d particles\n", capacity);
+        return FALSE;
+    }
+    particles->capacity = capacity;
+
+    float* p = particles->memory;
+    particles->x = p; p += capacity;
+    particles->y = p; p += capacity;
+    particles->vx = p; p += capacity;
+    particles->vy = p; p += capacity;
+    particles->gravity = p; p += capacity;
+    particles->age = p; p += capacity;
+    particles->life = p; p += capacity;
+    particles->size = p; p += capacity;
+    particles->kind = (unsigned char*)p;
+
+    rng_seed(&particles->rng, 0x9e3779b9u, RNG_STREAM_PARTICLES);
+    return TRUE;
+}
+
+void particles_free(Particles* particles) {
+    free(particles->memory);
+    memset(particles, 0, sizeof(*particles));
+}
+
+void particles_clear(Particles* particles) {
+    particles->tail = particles->head;
+}
+
+int particles_count(const Particles* particles) {
+    return (int)(particles->head - particles->tail);
+}
+
+int particles_slot(const Particles* particles, int n) {
+    return (int)((particles->tail + (unsigned int)n) & (unsigned int)(particles->capacity - 1));
+}
+
+void particles_emit(Particles* particles, int kind, float x, float y, int count) {
+    if (!particles->memory || kind < 0 || kind >= PARTICLE_KINDS) {
+        return;
+    }
+
+    const BurstStyle* style = &styles[kind];
+    unsigned int mask = (unsigned int)particles->capacity - 1;
+
+    for (int n = 0; n < count; n++) {
+        // Full ring: the oldest particle gives up its slot
+        if (particles->head - particles->tail == (unsigned int)particles->capacity) {
+            particles->tail++;
+        }
+        int i = (int)(particles->head++ & mask);
+
+        float angle = rng_range(&particles->rng, style->angle_min, style->angle_max);
+        float speed = rng_range(&particles->rng, style->speed_min, style->speed_max);
+        particles->x[i] = x;
+        particles->y[i] = y;
+        particles->vx[i] = cosf(angle) * speed;
+        particles->vy[i] = sinf(angle) * speed;
+        particles->gravity[i] = style->gravity;
+        particles->age[i] = 0.0f;
+        particles->life[i] = rng_range(&particles->rng, style->life_min, style->life_max);
+        particles->size[i] = rng_range(&particles->rng, style->size_min, style->size_max);
+        particles->kind[i] = (unsigned char)kind;
+    }
+}
+
+// Plain loop over contiguous arrays, the compiler vectorizes it
+static void update_range(Particles* particles, float dt, int begin, int end) {
+    float* x = particles->x;
+    float* y = particles->y;
+    float* vx = particles->vx;
+    float* vy = particles->vy;
+    const float* gravity = particles->gravity;
+    float* age = particles->age;
+
+    for (int i = begin; i < end; i++) {
+        vy[i] += gravity[i] * dt;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        age[i] += dt;
+    }
+}
+
+void particles_update(Particles* particles, float dt) {
+    int count = particles_count(particles);
+    if (count == 0) {
+        return;
+    }
+
+    // The live part of the ring is at most two runs of slots
+    int first = particles_slot(particles, 0);
+    int run = particles->capacity - first;
+    if (run > count) run = count;
+    update_range(particles, dt, first, first + run);
+    update_range(particles, dt, 0, count - run);
+
+    unsigned int mask = (unsigned int)particles->capacity - 1;
+    while (particles->tail != particles->head) {
+        int i = (int)(particles->tail & mask);
+        if (particles->age[i] < particles->life[i]) break;
+        particles->tail++;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Particle effects (egg splats, catches, level ups). No SDL in here, so bench can time it.
+// Particles are stored as a structure of arrays in a fixed ring: a burst takes the slots
+// after the newest particle, and when the ring is full it reuses the oldest ones. Nothing is
+// allocated after particles_init(). Every particle of a burst lives about as long, so the ring
+// stays close to age order and the dead ones at the old end are dropped in O(1) each.
+//
+// They are cosmetic and run on the render thread with the frame time, nothing here touches
+// the game state or its random streams, so replays are unaffected.
+
+#include "rng.h"
+
+// Limits for the particles, PARTICLE_CAPACITY must be a power of two
+#define PARTICLE_CAPACITY 8192
+
+// Burst kinds, also the sprite scene.c draws them with
+enum {
+    PARTICLE_SHELL,     // Egg that hit the ground: shell bits thrown up and falling back
+    PARTICLE_SPARKLE,   // Egg caught in the bag, or the chicken finishing a level
+    PARTICLE_KINDS
+};
+
+typedef struct {
+    int capacity;           // Power of two
+    unsigned int head;      // Ring positions, live particles are [tail, head)
+    unsigned int tail;
+
+    float* x;
+    float* y;
+    float* vx;              // Pixels per second
+    float* vy;
+    float* gravity;
+    float* age;             // Seconds
+    float* life;
+    float* size;
+    unsigned char* kind;
+
+    void* memory;           // Backs every array
+    Rng rng;                // RNG_STREAM_PARTICLES, the game's streams stay untouched
+} Particles;
+
+int particles_init(Particles* particles, int capacity);  // Returns FALSE on failure
+void particles_free(Particles* particles);
+void particles_clear(Particles* particles);
+
+// Starts count particles of a kind around (x, y)
+void particles_emit(Particles* particles, int kind, float x, float y, int count);
+
+// Moves every live particle by dt seconds and drops the expired ones at the old end
+void particles_update(Particles* particles, float dt);
+
+// Particles between tail and head, some of them may have expired already
+int particles_count(const Particles* particles);
+
+// Ring slot of the n-th particle from the oldest, for drawing
+int particles_slot(const Particles* particles, int n);
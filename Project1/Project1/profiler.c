@@ -0,0 +1,264 @@
+#define _CRT_SECURE_NO_WARNINGS
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Other_includes
+#include "constants.h"
+#include "profiler.h"
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+// Atomics for handing totals over to the frame thread, same as jobs.c
+#ifdef _WIN32
+static long atomic_add(volatile long* value, long amount) { return InterlockedExchangeAdd(value, amount) + amount; }
+static long atomic_take(volatile long* value) { return InterlockedExchange(value, 0); }
+static long atomic_get(volatile long* value) { return InterlockedCompareExchange(value, 0, 0); }
+#else
+static long atomic_add(volatile long* value, long amount) { return __atomic_add_fetch(value, amount, __ATOMIC_SEQ_CST); }
+static long atomic_take(volatile long* value) { return __atomic_exchange_n(value, 0, __ATOMIC_SEQ_CST); }
+static long atomic_get(volatile long* value) { return __atomic_load_n(value, __ATOMIC_SEQ_CST); }
+#endif
+
+// Other tracks count in tenths of a microsecond, a 32 bit long holds a few minutes of them
+#define PENDING_PER_MS 10000.0
+
+typedef struct {
+    int phase;
+    double start_us;    // Since the profiler's first clock read
+    double duration_us;
+} ProfileEvent;
+
+int profiler_enabled = 0;
+
+static const char* phase_names[PROF_COUNT] = {
+    "frame",
+    "input",
+    "update",
+    "update.ball",
+    "update.eggs",
+    "update.collision",
+    "update.spawn",
+    "particles",
+    "render",
+    "present"
+};
+
+// Per frame totals, frame n lives in slot n % PROFILER_FRAMES. Frame thread only.
+static float frame_ms[PROFILER_FRAMES][PROF_COUNT];
+static long long frame_index = 0;
+
+// Time the other tracks spent since the frame thread last took it
+static volatile long pending[PROFILER_TRACKS][PROF_COUNT];
+
+// Each track is only written by its own thread
+static double phase_start[PROFILER_TRACKS][PROF_COUNT];
+
+// Events the other tracks finished, waiting for the frame thread. A track only writes slots
+// the frame thread has read, the two counters only go up and wrap together.
+static ProfileEvent handoff[PROFILER_TRACKS][PROFILER_HANDOFF];
+static volatile long handoff_written[PROFILER_TRACKS];
+static volatile long handoff_read[PROFILER_TRACKS];
+
+// Events of every track for the trace export. Frame thread only.
+static ProfileEvent events[PROFILER_TRACKS][PROFILER_EVENTS];
+static long long event_index[PROFILER_TRACKS];
+
+static THREAD_LOCAL int current_track = PROFILER_TRACK_MAIN;
+
+// Set once by profiler_init(), only read after that
+#ifdef _WIN32
+static LARGE_INTEGER origin, frequency;
+#else
+static struct timespec origin;
+#endif
+
+static double now_us() {
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)(counter.QuadPart - origin.QuadPart) * 1e6 / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec - origin.tv_sec) * 1e6 + (ts.tv_nsec - origin.tv_nsec) / 1e3;
+#endif
+}
+
+void profiler_init() {
+#ifdef _WIN32
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&origin);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &origin);
+#endif
+}
+
+void profiler_frame_begin() {
+    memset(frame_ms[frame_index % PROFILER_FRAMES], 0, sizeof(frame_ms[0]));
+    profiler_begin(PROF_FRAME);
+}
+
+static void add_event(int track, const ProfileEvent* event) {
+    events[track][event_index[track] % PROFILER_EVENTS] = *event;
+    event_index[track]++;
+}
+
+void profiler_frame_end() {
+    profiler_end(PROF_FRAME);
+
+    // Whatever the other tracks finished while this frame was open counts towards it
+    float* totals = frame_ms[frame_index % PROFILER_FRAMES];
+    for (int track = 0; track < PROFILER_TRACKS; track++) {
+        if (track == PROFILER_TRACK_MAIN) continue;
+        for (int phase = 0; phase < PROF_COUNT; phase++) {
+            totals[phase] += (float)(atomic_take(&pending[track][phase]) / PENDING_PER_MS);
+        }
+
+        // The counter is bumped after the event is written, so everything below it is complete
+        unsigned long read = (unsigned long)handoff_read[track];
+        unsigned long written = (unsigned long)atomic_get(&handoff_written[track]);
+        for (unsigned long e = read; e != written; e++) {
+            add_event(track, &handoff[track][e % PROFILER_HANDOFF]);
+        }
+        atomic_add(&handoff_read[track], (long)(written - read));
+    }
+    frame_index++;
+}
+
+void profiler_set_track(int track) {
+    if (track >= 0 && track < PROFILER_TRACKS) {
+        current_track = track;
+    }
+}
+
+void profiler_begin(int phase) {
+    phase_start[current_track][phase] = now_us();
+}
+
+void profiler_end(int phase) {
+    int track = current_track;
+    double end = now_us();
+    double start = phase_start[track][phase];
+    double duration = end - start;
+
+    ProfileEvent event = { phase, start, duration };
+    if (track == PROFILER_TRACK_MAIN) {
+        frame_ms[frame_index % PROFILER_FRAMES][phase] += (float)(duration / 1000.0);
+        add_event(track, &event);
+        return;
+    }
+
+    atomic_add(&pending[track][phase], (long)(duration * PENDING_PER_MS / 1000.0));
+
+    // Queue the event for the frame thread, or drop it when the frame thread is that far behind
+    unsigned long written = (unsigned long)handoff_written[track];
+    if (written - (unsigned long)atomic_get(&handoff_read[track]) < PROFILER_HANDOFF) {
+        handoff[track][written % PROFILER_HANDOFF] = event;
+        atomic_add(&handoff_written[track], 1);
+    }
+}
+
+const char* profiler_phase_name(int phase) {
+    return phase_names[phase];
+}
+
+int profiler_frame_count() {
+    return frame_index < PROFILER_FRAMES ? (int)frame_index : PROFILER_FRAMES;
+}
+
+double profiler_frame_ms(int phase, int frames_ago) {
+    if (frames_ago < 0 || frames_ago >= profiler_frame_count()) {
+        return 0.0;
+    }
+    return frame_ms[(frame_index - 1 - frames_ago) % PROFILER_FRAMES][phase];
+}
+
+static int compare_float(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+void profiler_percentiles(int phase, double* p50, double* p99) {
+    float sorted[PROFILER_FRAMES];
+    int count = profiler_frame_count();
+
+    if (count == 0) {
+        *p50 = *p99 = 0.0;
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        sorted[i] = (float)profiler_frame_ms(phase, i);
+    }
+    qsort(sorted, count, sizeof(float), compare_float);
+
+    // Nearest rank
+    *p50 = sorted[(count - 1) * 50 / 100];
+    *p99 = sorted[(count - 1) * 99 / 100];
+}
+
+int profiler_export_csv(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Profiler: can't write %s\n", path);
+        return FALSE;
+    }
+
+    fprintf(file, "frame");
+    for (int p = 0; p < PROF_COUNT; p++) {
+        fprintf(file, ",%s_ms", phase_names[p]);
+    }
+    fprintf(file, "\n");
+
+    // Oldest first
+    int count = profiler_frame_count();
+    for (int i = count - 1; i >= 0; i--) {
+        fprintf(file, "%lld", frame_index - 1 - i);
+        for (int p = 0; p < PROF_COUNT; p++) {
+            fprintf(file, ",%.4f", profiler_frame_ms(p, i));
+        }
+        fprintf(file, "\n");
+    }
+
+    return fclose(file) == 0;
+}
+
+int profiler_export_trace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Profiler: can't write %s\n", path);
+        return FALSE;
+    }
+
+    // Complete ("X") events, one thread id per track
+    fprintf(file, "{\"traceEvents\":[\n");
+    int written = 0;
+    for (int track = 0; track < PROFILER_TRACKS; track++) {
+        long long last = event_index[track];
+        long long first = last > PROFILER_EVENTS ? last - PROFILER_EVENTS : 0;
+        for (long long e = first; e < last; e++) {
+            const ProfileEvent* event = &events[track][e % PROFILER_EVENTS];
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}\n",
+                written++ ? "," : "", phase_names[event->phase], track + 1, event->start_us, event->duration_us);
+        }
+    }
+    fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+// Per-phase frame profiler. No SDL in here, so the game logic and the benchmark can use it.
+// Each frame keeps the total time spent in every phase (a phase can run several times a
+// frame, e.g. one update per sim tick) in a ring of the last PROFILER_FRAMES frames, and
+// every begin / end pair is also kept as an event for the Chrome trace export.
+//
+// Timers cost a clock read each, so they do nothing until profiler_enabled is set.
+//
+// Phases can be timed from more than one thread. Each thread picks a track, which keeps
+// its own timers and events (one row per track in the trace). Frames belong to the
+// PROFILER_TRACK_MAIN thread, the other tracks add their time to an atomic total and queue
+// their events, and profiler_frame_end() takes both over. Everything that reads frames or
+// events below is for the PROFILER_TRACK_MAIN thread only.
+//
+// Call profiler_init() before any thread starts timing.
+
+// Limits for the profiler
+#define PROFILER_FRAMES 512
+#define PROFILER_EVENTS 16384
+#define PROFILER_HANDOFF 1024   // Events another track can queue between two frames, later ones are dropped
+#define PROFILER_TRACKS 2
+
+// Tracks
+#define PROFILER_TRACK_MAIN 0
+#define PROFILER_TRACK_SIM 1
+
+enum {
+    PROF_FRAME,
+    PROF_INPUT,
+    PROF_UPDATE,
+    PROF_UPDATE_BALL,       // Sub-phases of update()
+    PROF_UPDATE_EGGS,
+    PROF_UPDATE_COLLISION,
+    PROF_UPDATE_SPAWN,
+    PROF_PARTICLES,
+    PROF_RENDER,
+    PROF_PRESENT,
+    PROF_COUNT
+};
+
+extern int profiler_enabled;
+
+#define PROFILE_BEGIN(phase) do { if (profiler_enabled) profiler_begin(phase); } while (0)
+#define PROFILE_END(phase) do { if (profiler_enabled) profiler_end(phase); } while (0)
+
+// Starts the clock the events are timed against
+void profiler_init();
+
+// Frames are numbered from 0, profiler_frame_end() moves to the next slot of the ring
+void profiler_frame_begin();
+void profiler_frame_end();
+
+void profiler_begin(int phase);
+void profiler_end(int phase);
+
+// Track for the calling thread, PROFILER_TRACK_MAIN until set
+void profiler_set_track(int track);
+
+const char* profiler_phase_name(int phase);
+
+// Finished frames in the ring, up to PROFILER_FRAMES
+int profiler_frame_count();
+
+// Time spent in phase during a finished frame, 0 is the newest
+double profiler_frame_ms(int phase, int frames_ago);
+
+// Median and 99th percentile over the finished frames in the ring
+void profiler_percentiles(int phase, double* p50, double* p99);
+
+// One row per frame, one column per phase, in milliseconds
+int profiler_export_csv(const char* path);
+
+// Chrome trace event format, load it in chrome://tracing or ui.perfetto.dev
+int profiler_export_trace(const char* path);
@@ -0,0 +1,483 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Other_includes
+#include "constants.h"
+#include "raster.h"
+#include "archive.h"
+#include "jobs.h"
+
+// Same switch as eggs.c, define RASTER_NO_SIMD to force the C version
+#if !defined(RASTER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+// SDL_PIXELFORMAT_RGBA32 on a little endian machine (ABGR8888), what pack.c writes
+#define RASTER_ARCHIVE_FORMAT 0x16762004u
+
+// Built-in font, ' ' to '_', lowercase is drawn as uppercase
+#define FONT_FIRST ' '
+#define FONT_GLYPHS 64
+#define FONT_WIDTH 5
+#define FONT_HEIGHT 7
+
+// Columns of each glyph, bit 0 is the top row
+static const unsigned char font_columns[FONT_GLYPHS][FONT_WIDTH] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 },
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 },
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+    { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 },
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 },
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 },
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x36, 0x36, 0x00, 0x00 }, { 0x00, 0x56, 0x36, 0x00, 0x00 },
+    { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, { 0x41, 0x22, 0x14, 0x08, 0x00 }, { 0x02, 0x01, 0x51, 0x09, 0x06 },
+    { 0x32, 0x49, 0x79, 0x41, 0x3E }, { 0x7E, 0x11, 0x11, 0x11, 0x7E }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x01, 0x01 }, { 0x3E, 0x41, 0x41, 0x51, 0x32 },
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 },
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x04, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x46, 0x49, 0x49, 0x49, 0x31 },
+    { 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x7F, 0x20, 0x18, 0x20, 0x7F },
+    { 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x00, 0x7F, 0x41, 0x41 },
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x41, 0x41, 0x7F, 0x00, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, { 0x40, 0x40, 0x40, 0x40, 0x40 }
+};
+
+// Stand-ins when there's no archive: the same bag and chicken sizes bench collides with, and a color each
+static const int standin_sizes[SPRITE_COUNT][2] = {
+    { WINDOW_WIDTH, WINDOW_HEIGHT },
+    { BAG_WIDTH, BAG_HEIGHT },
+    { CHICKEN_WIDTH, CHICKEN_HEIGHT }, { CHICKEN_WIDTH, CHICKEN_HEIGHT }, { CHICKEN_WIDTH, CHICKEN_HEIGHT }, { CHICKEN_WIDTH, CHICKEN_HEIGHT },
+    { RASTER_STANDIN_SIZE, RASTER_STANDIN_SIZE },
+    { RASTER_STANDIN_SIZE, RASTER_STANDIN_SIZE },
+    { RASTER_STANDIN_SIZE, RASTER_STANDIN_SIZE },
+    { 1, 1 }
+};
+static const SceneColor standin_colors[SPRITE_COUNT] = {
+    { 30, 90, 50, 255 },
+    { 150, 100, 50, 255 },
+    { 240, 240, 230, 255 }, { 240, 240, 230, 255 }, { 230, 230, 220, 255 }, { 230, 230, 220, 255 },
+    { 250, 240, 200, 255 },
+    { 200, 190, 160, 255 },
+    { 255, 200, 40, 255 },
+    { 255, 255, 255, 255 }
+};
+
+static int alloc_image(RasterImage* image, int width, int height) {
+    image->width = width;
+    image->height = height;
+    image->pixels = calloc((size_t)width * height, 4);
+    return image->pixels != NULL;
+}
+
+// Background is a vertical gradient, the rest are ellipses with a clear outside so the
+// alpha blending gets exercised
+static int make_standin(RasterImage* image, int sprite) {
+    int width = standin_sizes[sprite][0];
+    int height = standin_sizes[sprite][1];
+    if (!alloc_image(image, width, height)) {
+        return FALSE;
+    }
+
+    SceneColor color = standin_colors[sprite];
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char* pixel = image->pixels + ((size_t)y * width + x) * 4;
+            unsigned char alpha = 255;
+            int shade = 255;
+            if (sprite == SPRITE_BACKGROUND) {
+                shade = 128 + 127 * y / height;
+            }
+            else if (width > 1) {
+                // Inside the ellipse through the edges' midpoints, in units of the half size
+                long dx = 2 * x + 1 - width;
+                long dy = 2 * y + 1 - height;
+                if (dx * dx * height * height + dy * dy * width * width > (long)width * width * height * height) {
+                    alpha = 0;
+                }
+            }
+            pixel[0] = (unsigned char)(color.r * shade / 255);
+            pixel[1] = (unsigned char)(color.g * shade / 255);
+            pixel[2] = (unsigned char)(color.b * shade / 255);
+            pixel[3] = alpha;
+        }
+    }
+    return TRUE;
+}
+
+static int load_image(RasterImage* image, const Archive* archive, const char* path) {
+    const ArchiveEntry* entry = archive_find(archive, path);
+    if (!entry || entry->format != RASTER_ARCHIVE_FORMAT) {
+        return FALSE;
+    }
+    if (!alloc_image(image, (int)entry->width, (int)entry->height)) {
+        return FALSE;
+    }
+
+    const unsigned char* src = archive_pixels(archive, entry);
+    for (int y = 0; y < image->height; y++) {
+        memcpy(image->pixels + (size_t)y * image->width * 4, src + (size_t)y * entry->pitch, (size_t)image->width * 4);
+    }
+    return TRUE;
+}
+
+static int make_font(RasterImage* font) {
+    if (!alloc_image(font, FONT_GLYPHS * FONT_WIDTH, FONT_HEIGHT)) {
+        return FALSE;
+    }
+
+    for (int glyph = 0; glyph < FONT_GLYPHS; glyph++) {
+        for (int column = 0; column < FONT_WIDTH; column++) {
+            for (int row = 0; row < FONT_HEIGHT; row++) {
+                unsigned char* pixel = font->pixels + ((size_t)row * font->width + glyph * FONT_WIDTH + column) * 4;
+                memset(pixel, 255, 3);
+                pixel[3] = (font_columns[glyph][column] >> row) & 1 ? 255 : 0;
+            }
+        }
+    }
+    return TRUE;
+}
+
+// Game units to framebuffer pixels, rounding down for negatives too
+static int to_pixels(int units, int pixels, int game_size) {
+    long long scaled = (long long)units * pixels;
+    long long result = scaled / game_size;
+    if (scaled % game_size != 0 && scaled < 0) result--;
+    return (int)result;
+}
+
+static void push_blit(Raster* raster, const RasterImage* image, int src_x, int src_y, int src_w, int src_h,
+    const SceneRect* dst, SceneColor color, int flip_x) {
+    if (raster->num_blits == raster->max_blits) {
+        int max_blits = raster->max_blits * 2;
+        RasterBlit* blits = realloc(raster->blits, sizeof(RasterBlit) * max_blits);
+        if (!blits) {
+            return;
+        }
+        raster->blits = blits;
+        raster->max_blits = max_blits;
+    }
+
+    RasterBlit* blit = &raster->blits[raster->num_blits++];
+    blit->image = image;
+    blit->src_x = src_x;
+    blit->src_y = src_y;
+    blit->src_w = src_w;
+    blit->src_h = src_h;
+    if (dst) {
+        blit->x0 = to_pixels(dst->x, raster->width, WINDOW_WIDTH);
+        blit->y0 = to_pixels(dst->y, raster->height, WINDOW_HEIGHT);
+        blit->x1 = to_pixels(dst->x + dst->w, raster->width, WINDOW_WIDTH);
+        blit->y1 = to_pixels(dst->y + dst->h, raster->height, WINDOW_HEIGHT);
+    }
+    else {
+        blit->x0 = 0;
+        blit->y0 = 0;
+        blit->x1 = raster->width;
+        blit->y1 = raster->height;
+    }
+    blit->color = color;
+    blit->flip_x = flip_x;
+}
+
+// Canvas
+
+static void raster_sprite(void* context, int sprite, const SceneRect* dst, SceneColor color, int flip_x) {
+    Raster* raster = context;
+    const RasterImage* image = &raster->sprites[sprite];
+    push_blit(raster, image, 0, 0, image->width, image->height, dst, color, flip_x);
+}
+
+static void raster_fill(void* context, const SceneRect* dst, SceneColor color) {
+    raster_sprite(context, SPRITE_WHITE, dst, color, FALSE);
+}
+
+// Glyph pixels are font_size / 8 game units, close to what the TTF fonts come out at
+static void raster_text(void* context, const char* font_path, int font_size, const char* text, int x, int y, SceneColor color) {
+    Raster* raster = context;
+    (void)font_path;
+
+    int scale = font_size / 8 > 0 ? font_size / 8 : 1;
+    int length = (int)strlen(text);
+    int width = (length * (FONT_WIDTH + 1) - 1) * scale;
+    int height = FONT_HEIGHT * scale;
+    SceneRect glyph_rect = { x - width / 2, y - height / 2, FONT_WIDTH * scale, height };
+
+    for (int i = 0; i < length; i++, glyph_rect.x += (FONT_WIDTH + 1) * scale) {
+        int c = (unsigned char)text[i];
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        if (c <= FONT_FIRST || c >= FONT_FIRST + FONT_GLYPHS) continue;
+
+        int glyph = c - FONT_FIRST;
+        push_blit(raster, &raster->font, glyph * FONT_WIDTH, 0, FONT_WIDTH, FONT_HEIGHT, &glyph_rect, color, FALSE);
+    }
+}
+
+static void raster_sprite_size(void* context, int sprite, int* width, int* height) {
+    Raster* raster = context;
+    *width = raster->sprites[sprite].width;
+    *height = raster->sprites[sprite].height;
+}
+
+// Blending, the same rounding in both kernels so they write the same bytes
+
+static inline int div255(int x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline void blend_pixel(unsigned char* dst, const unsigned char* src, SceneColor color) {
+    int alpha = div255(src[3] * color.a);
+    if (alpha == 0) {
+        return;
+    }
+
+    int keep = 255 - alpha;
+    dst[0] = (unsigned char)div255(div255(src[0] * color.r) * alpha + dst[0] * keep);
+    dst[1] = (unsigned char)div255(div255(src[1] * color.g) * alpha + dst[1] * keep);
+    dst[2] = (unsigned char)div255(div255(src[2] * color.b) * alpha + dst[2] * keep);
+    dst[3] = (unsigned char)div255(255 * alpha + dst[3] * keep);
+}
+
+#ifdef RASTER_SSE2
+static inline __m128i div255_epu16(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Two pixels in 16 bit lanes, r g b a r g b a
+static inline __m128i blend_two(__m128i src, __m128i dst, __m128i tint) {
+    const __m128i rgb_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i opaque = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i full = _mm_set1_epi16(255);
+
+    src = div255_epu16(_mm_mullo_epi16(src, tint));
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    src = _mm_or_si128(_mm_and_si128(src, rgb_mask), opaque);
+
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, _mm_sub_epi16(full, alpha)));
+    return div255_epu16(sum);
+}
+
+static inline void blend_four(unsigned char* dst, __m128i src, __m128i tint) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i pixels = _mm_loadu_si128((const __m128i*)dst);
+    __m128i low = blend_two(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(pixels, zero), tint);
+    __m128i high = blend_two(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(pixels, zero), tint);
+    _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(low, high));
+}
+#endif
+
+// Nearest neighbour, sampling the source at the middle of each framebuffer pixel
+static void draw_blit(Raster* raster, const RasterBlit* blit, int top, int bottom) {
+    int dst_w = blit->x1 - blit->x0;
+    int dst_h = blit->y1 - blit->y0;
+    if (dst_w <= 0 || dst_h <= 0 || blit->src_w <= 0 || blit->src_h <= 0) {
+        return;
+    }
+
+    int x0 = blit->x0 > 0 ? blit->x0 : 0;
+    int x1 = blit->x1 < raster->width ? blit->x1 : raster->width;
+    int y0 = blit->y0 > top ? blit->y0 : top;
+    int y1 = blit->y1 < bottom ? blit->y1 : bottom;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    // 16.16 source columns, rounded down on both counts so the last one stays inside the image
+    long long step = ((long long)blit->src_w << 16) / dst_w;
+    long long start = (((long long)(2 * (x0 - blit->x0) + 1) * blit->src_w) << 16) / (2 * dst_w);
+    const RasterImage* image = blit->image;
+    SceneColor color = blit->color;
+
+#ifdef RASTER_SSE2
+    const __m128i tint = _mm_set_epi16(color.a, color.b, color.g, color.r, color.a, color.b, color.g, color.r);
+#endif
+
+    for (int y = y0; y < y1; y++) {
+        int v = (int)((long long)(2 * (y - blit->y0) + 1) * blit->src_h / (2 * dst_h));
+        const unsigned int* src_row = (const unsigned int*)(image->pixels + ((size_t)(blit->src_y + v) * image->width + blit->src_x) * 4);
+        unsigned char* dst = raster->pixels + ((size_t)y * raster->width + x0) * 4;
+
+        long long u = start;
+        int x = x0;
+#ifdef RASTER_SSE2
+        for (; x + 4 <= x1; x += 4, dst += 16) {
+            int u0 = (int)(u >> 16); u += step;
+            int u1 = (int)(u >> 16); u += step;
+            int u2 = (int)(u >> 16); u += step;
+            int u3 = (int)(u >> 16); u += step;
+            if (blit->flip_x) {
+                u0 = blit->src_w - 1 - u0;
+                u1 = blit->src_w - 1 - u1;
+                u2 = blit->src_w - 1 - u2;
+                u3 = blit->src_w - 1 - u3;
+            }
+            __m128i src = _mm_set_epi32((int)src_row[u3], (int)src_row[u2], (int)src_row[u1], (int)src_row[u0]);
+            blend_four(dst, src, tint);
+        }
+#endif
+        for (; x < x1; x++, dst += 4) {
+            int column = (int)(u >> 16);
+            u += step;
+            if (blit->flip_x) column = blit->src_w - 1 - column;
+            blend_pixel(dst, (const unsigned char*)&src_row[column], color);
+        }
+    }
+}
+
+// One job per band, every blit in order clipped to the band's rows
+static void draw_bands(void* data, int chunk, int begin, int end) {
+    Raster* raster = data;
+    (void)chunk;
+
+    int top = begin * RASTER_BAND_ROWS;
+    int bottom = end * RASTER_BAND_ROWS;
+    if (bottom > raster->height) bottom = raster->height;
+
+    for (int i = 0; i < raster->num_blits; i++) {
+        draw_blit(raster, &raster->blits[i], top, bottom);
+    }
+}
+
+int raster_init(Raster* raster, int width, int height, const char* archive_path) {
+    memset(raster, 0, sizeof(*raster));
+    raster->width = width;
+    raster->height = height;
+    raster->pixels = malloc((size_t)width * height * 4);
+    raster->max_blits = RASTER_INITIAL_BLITS;
+    raster->blits = malloc(sizeof(RasterBlit) * raster->max_blits);
+    if (!raster->pixels || !raster->blits || !make_font(&raster->font)) {
+        fprintf(stderr, "Error: Could not allocate a %dx%d raster\n", width, height);
+        raster_free(raster);
+        return FALSE;
+    }
+
+    // Every sprite from the archive or none of them, half real half stand-in frames would be no use as goldens
+    Archive archive;
+    if (archive_path && archive_open(&archive, archive_path)) {
+        raster->from_archive = TRUE;
+        for (int i = 0; i < SPRITE_COUNT && raster->from_archive; i++) {
+            if (assets_sprite_file(i)) {
+                raster->from_archive = load_image(&raster->sprites[i], &archive, assets_sprite_file(i));
+            }
+        }
+        archive_close(&archive);
+
+        if (!raster->from_archive) {
+            fprintf(stderr, "Raster: %s is missing sprites, using stand-ins\n", archive_path);
+            for (int i = 0; i < SPRITE_COUNT; i++) {
+                free(raster->sprites[i].pixels);
+                raster->sprites[i].pixels = NULL;
+            }
+        }
+    }
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (!raster->sprites[i].pixels && !make_standin(&raster->sprites[i], i)) {
+            raster_free(raster);
+            return FALSE;
+        }
+    }
+
+    raster->canvas.context = raster;
+    raster->canvas.sprite = raster_sprite;
+    raster->canvas.fill = raster_fill;
+    raster->canvas.text = raster_text;
+    raster->canvas.sprite_size = raster_sprite_size;
+    return TRUE;
+}
+
+void raster_free(Raster* raster) {
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        free(raster->sprites[i].pixels);
+    }
+    free(raster->font.pixels);
+    free(raster->pixels);
+    free(raster->blits);
+    memset(raster, 0, sizeof(*raster));
+}
+
+void raster_begin(Raster* raster) {
+    size_t count = (size_t)raster->width * raster->height;
+    for (size_t i = 0; i < count; i++) {
+        unsigned char* pixel = raster->pixels + i * 4;
+        pixel[0] = pixel[1] = pixel[2] = 0;
+        pixel[3] = 255;
+    }
+    raster->num_blits = 0;
+}
+
+void raster_finish(Raster* raster) {
+    int bands = (raster->height + RASTER_BAND_ROWS - 1) / RASTER_BAND_ROWS;
+    jobs_parallel_for(bands, 1, draw_bands, raster);
+    raster->num_blits = 0;
+}
+
+const char* raster_kernel_name() {
+#ifdef RASTER_SSE2
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+int raster_write_ppm(const char* path, const unsigned char* pixels, int width, int height) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not write %s\n", path);
+        return FALSE;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    unsigned char* row = malloc((size_t)width * 3);
+    int ok = row != NULL;
+    for (int y = 0; y < height && ok; y++) {
+        const unsigned char* src = pixels + (size_t)y * width * 4;
+        for (int x = 0; x < width; x++) {
+            memcpy(row + x * 3, src + x * 4, 3);
+        }
+        ok = fwrite(row, 3, width, file) == (size_t)width;
+    }
+
+    free(row);
+    fclose(file);
+    return ok;
+}
+
+unsigned char* raster_read_ppm(const char* path, int* width, int* height) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    int max_value = 0;
+    if (fscanf(file, "P6 %d %d %d", width, height, &max_value) != 3 || max_value != 255 ||
+        *width <= 0 || *height <= 0 || fgetc(file) == EOF) {
+        fprintf(stderr, "Error: %s isn't a P6 file\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    size_t count = (size_t)*width * *height;
+    unsigned char* pixels = malloc(count * 4);
+    if (!pixels || fread(pixels, 3, count, file) != count) {
+        fprintf(stderr, "Error: %s is cut short\n", path);
+        free(pixels);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+
+    // Spread RGB out to RGBA in place, from the back
+    for (size_t i = count; i-- > 0;) {
+        pixels[i * 4 + 3] = 255;
+        pixels[i * 4 + 2] = pixels[i * 3 + 2];
+        pixels[i * 4 + 1] = pixels[i * 3 + 1];
+        pixels[i * 4 + 0] = pixels[i * 3 + 0];
+    }
+    return pixels;
+}
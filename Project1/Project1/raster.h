@@ -0,0 +1,73 @@
+#pragma once
+
+// Software renderer: draws the same frames as render() (scene.h) into memory, with no SDL,
+// window or GPU, for golden images and rendering benchmarks on CI boxes. Drawing through
+// raster->canvas only records blits, raster_finish() runs them over horizontal bands of the
+// framebuffer on the job system (jobs.h), each band clipped to its own rows, so the threads
+// never touch the same pixels and the result doesn't depend on the thread count.
+//
+// Sprites come from the asset archive (archive.h) when there is one, otherwise every sprite is
+// a flat colored stand-in at the size bench uses. Text is a built-in 5x7 pixel font, SDL_ttf
+// isn't around headless, so the font paths are ignored. Blending is SDL's BLENDMODE_BLEND
+// in 8 bit integer math, four pixels at a time with SSE2 (define RASTER_NO_SIMD for the C
+// version, both give the same bytes).
+
+#include "scene.h"
+
+// Framebuffer rows per band handed to a job
+#define RASTER_BAND_ROWS 32
+
+// Blits the list starts with, it doubles when a frame needs more
+#define RASTER_INITIAL_BLITS 1024
+
+// Size of a stand-in sprite with no image to load
+#define RASTER_STANDIN_SIZE 64
+
+typedef struct {
+    int width, height;
+    unsigned char* pixels;  // RGBA, 4 * width bytes per row
+} RasterImage;
+
+// One textured rect: a part of an image scaled onto the framebuffer, tinted and blended
+typedef struct {
+    const RasterImage* image;
+    int src_x, src_y, src_w, src_h;
+    int x0, y0, x1, y1;     // Framebuffer pixels, not clipped
+    SceneColor color;
+    int flip_x;
+} RasterBlit;
+
+typedef struct {
+    int width, height;      // Framebuffer size in pixels, the scene is stretched over it
+    unsigned char* pixels;  // RGBA, 4 * width bytes per row
+
+    RasterImage sprites[SPRITE_COUNT];
+    RasterImage font;       // Glyphs for ' ' to '_' side by side
+    int from_archive;       // The sprites are the real assets
+
+    RasterBlit* blits;
+    int num_blits;
+    int max_blits;
+
+    Canvas canvas;          // Draws into this raster
+} Raster;
+
+// Returns FALSE on failure. Loads the sprites from archive_path if it opens, NULL skips it.
+int raster_init(Raster* raster, int width, int height, const char* archive_path);
+void raster_free(Raster* raster);
+
+// Starts a frame: clears the framebuffer to opaque black and drops the recorded blits
+void raster_begin(Raster* raster);
+
+// Draws the recorded blits, split into bands across the job workers
+void raster_finish(Raster* raster);
+
+// Name of the blend kernel raster_finish() uses
+const char* raster_kernel_name();
+
+// Binary PPM (P6), alpha is dropped. Returns FALSE on failure.
+int raster_write_ppm(const char* path, const unsigned char* pixels, int width, int height);
+
+// Reads a P6 file written by raster_write_ppm() into RGBA with opaque alpha, NULL on failure.
+// Free the pixels with free().
+unsigned char* raster_read_ppm(const char* path, int* width, int* height);
@@ -0,0 +1,169 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Other_includes
+#include "replay.h"
+
+void replay_init(Replay* replay, unsigned int seed, int sim_hz, const GameConfig* config) {
+    memset(replay, 0, sizeof(*replay));
+    memcpy(replay->header.magic, REPLAY_MAGIC, 4);
+    replay->header.version = REPLAY_VERSION;
+    replay->header.seed = seed;
+    replay->header.sim_hz = (uint32_t)sim_hz;
+    replay->header.check_interval = REPLAY_CHECK_INTERVAL;
+    replay->header.capacity = config->capacity;
+    replay->header.egg_count = config->egg_count;
+    replay->header.ball_width = config->ball_width;
+    replay->header.ball_height = config->ball_height;
+    replay->header.block_width = config->block_width;
+    replay->header.block_height = config->block_height;
+}
+
+void replay_free(Replay* replay) {
+    free(replay->runs);
+    free(replay->checksums);
+    memset(replay, 0, sizeof(*replay));
+}
+
+// Doubles the array when it's full
+static int grow(void** array, int* max, int count, size_t element_size) {
+    if (count < *max) {
+        return TRUE;
+    }
+    int new_max = *max ? *max * 2 : 1024;
+    void* bigger = realloc(*array, element_size * new_max);
+    if (!bigger) {
+        fprintf(stderr, "Replay: out of memory after %d entries\n", count);
+        return FALSE;
+    }
+    *array = bigger;
+    *max = new_max;
+    return TRUE;
+}
+
+int replay_record(Replay* replay, unsigned int input, unsigned int checksum) {
+    ReplayHeader* header = &replay->header;
+
+    ReplayRun* last = header->num_runs ? &replay->runs[header->num_runs - 1] : NULL;
+    if (last && last->input == input && last->length < UINT16_MAX) {
+        last->length++;
+    }
+    else {
+        if (!grow((void**)&replay->runs, &replay->max_runs, header->num_runs, sizeof(ReplayRun))) {
+            return FALSE;
+        }
+        ReplayRun* run = &replay->runs[header->num_runs++];
+        run->length = 1;
+        run->input = (uint8_t)input;
+        run->reserved = 0;
+    }
+
+    header->num_ticks++;
+    if (header->num_ticks % header->check_interval == 0) {
+        if (!grow((void**)&replay->checksums, &replay->max_checksums, header->num_checksums, sizeof(uint32_t))) {
+            return FALSE;
+        }
+        replay->checksums[header->num_checksums++] = checksum;
+    }
+    return TRUE;
+}
+
+int replay_save(const Replay* replay, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Replay: can't write %s\n", path);
+        return FALSE;
+    }
+
+    const ReplayHeader* header = &replay->header;
+    int ok = fwrite(header, sizeof(*header), 1, file) == 1 &&
+        fwrite(replay->runs, sizeof(ReplayRun), header->num_runs, file) == header->num_runs &&
+        fwrite(replay->checksums, sizeof(uint32_t), header->num_checksums, file) == header->num_checksums;
+    ok = fclose(file) == 0 && ok;
+
+    if (!ok) {
+        fprintf(stderr, "Replay: error writing %s\n", path);
+    }
+    return ok;
+}
+
+int replay_load(Replay* replay, const char* path) {
+    memset(replay, 0, sizeof(*replay));
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Replay: can't open %s\n", path);
+        return FALSE;
+    }
+
+    ReplayHeader* header = &replay->header;
+    int ok = fread(header, sizeof(*header), 1, file) == 1 &&
+        memcmp(header->magic, REPLAY_MAGIC, 4) == 0 &&
+        header->version == REPLAY_VERSION &&
+        header->check_interval > 0 &&
+        header->sim_hz > 0;
+
+    if (ok) {
+        replay->max_runs = (int)header->num_runs;
+        replay->max_checksums = (int)header->num_checksums;
+        replay->runs = malloc(sizeof(ReplayRun) * (header->num_runs + 1));
+        replay->checksums = malloc(sizeof(uint32_t) * (header->num_checksums + 1));
+        ok = replay->runs && replay->checksums &&
+            fread(replay->runs, sizeof(ReplayRun), header->num_runs, file) == header->num_runs &&
+            fread(replay->checksums, sizeof(uint32_t), header->num_checksums, file) == header->num_checksums;
+    }
+    fclose(file);
+
+    if (!ok) {
+        fprintf(stderr, "Replay: %s is damaged or from another version\n", path);
+        replay_free(replay);
+    }
+    return ok;
+}
+
+void replay_config(const Replay* replay, GameConfig* config) {
+    game_default_config(config);
+    config->capacity = replay->header.capacity;
+    config->egg_count = replay->header.egg_count;
+    config->ball_width = replay->header.ball_width;
+    config->ball_height = replay->header.ball_height;
+    config->block_width = replay->header.block_width;
+    config->block_height = replay->header.block_height;
+}
+
+int replay_next(Replay* replay, unsigned int* input) {
+    while (replay->run < replay->header.num_runs &&
+        replay->run_offset >= replay->runs[replay->run].length) {
+        replay->run++;
+        replay->run_offset = 0;
+    }
+    if (replay->run >= replay->header.num_runs || replay->tick >= replay->header.num_ticks) {
+        return FALSE;
+    }
+
+    *input = replay->runs[replay->run].input;
+    replay->run_offset++;
+    replay->tick++;
+    return TRUE;
+}
+
+void replay_check(Replay* replay, unsigned int checksum) {
+    const ReplayHeader* header = &replay->header;
+    if (replay->tick % header->check_interval != 0) {
+        return;
+    }
+
+    uint32_t index = replay->tick / header->check_interval - 1;
+    if (index < header->num_checksums && replay->checksums[index] != checksum) {
+        // Only the first one matters for tracking it down, everything after it drifts too
+        if (replay->mismatches == 0) {
+            fprintf(stderr, "Replay: checksum mismatch at tick %u (%08x, recorded %08x)\n",
+                replay->tick, checksum, replay->checksums[index]);
+        }
+        replay->mismatches++;
+    }
+}
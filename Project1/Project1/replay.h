@@ -0,0 +1,72 @@
+#pragma once
+
+// Input recording and replay. A replay is the seed, the game config and the INPUT_* buttons
+// of every sim tick, run-length encoded since buttons are held for many ticks, plus a
+// game_checksum() every REPLAY_CHECK_INTERVAL ticks to catch runs that drift apart.
+// No SDL in here, bench replays headless and main.c replays with rendering.
+//
+// Layout (little endian): ReplayHeader, ReplayRun[num_runs], uint32_t checksums[num_checksums]
+
+#include <stdint.h>
+
+#include "game.h"
+
+#define REPLAY_MAGIC "PCRP"
+#define REPLAY_VERSION 4
+#define REPLAY_CHECK_INTERVAL 60
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t seed;
+    uint32_t sim_hz;
+    uint32_t num_ticks;
+    uint32_t num_runs;
+    uint32_t num_checksums;
+    uint32_t check_interval;
+
+    // GameConfig fields that change the simulation
+    int32_t capacity;
+    int32_t egg_count;
+    float ball_width, ball_height;
+    float block_width, block_height;
+} ReplayHeader;
+
+typedef struct {
+    uint16_t length;    // Ticks the buttons were held
+    uint8_t input;
+    uint8_t reserved;
+} ReplayRun;
+
+typedef struct {
+    ReplayHeader header;
+    ReplayRun* runs;
+    uint32_t* checksums;
+    int max_runs;
+    int max_checksums;
+
+    // Playback position
+    uint32_t tick;
+    uint32_t run;
+    uint32_t run_offset;
+    int mismatches;
+} Replay;
+
+// Starts an empty recording
+void replay_init(Replay* replay, unsigned int seed, int sim_hz, const GameConfig* config);
+void replay_free(Replay* replay);
+
+// Appends one tick: the buttons it ran with and the checksum after it
+int replay_record(Replay* replay, unsigned int input, unsigned int checksum);
+
+int replay_save(const Replay* replay, const char* path);
+int replay_load(Replay* replay, const char* path);
+
+// The config the recording was made with
+void replay_config(const Replay* replay, GameConfig* config);
+
+// Playback: buttons for the next tick, FALSE when the log is over
+int replay_next(Replay* replay, unsigned int* input);
+
+// Call after the tick replay_next() returned, counts and reports mismatches
+void replay_check(Replay* replay, unsigned int checksum);
@@ -0,0 +1,132 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+
+// User_defined_library
+#include <SDL.h>
+
+// Other_includes
+#include "resources.h"
+
+typedef struct {
+    char key[RESOURCE_MAX_KEY_LENGTH];
+    int refs;           // 0 means the slot is free
+    size_t bytes;
+    SDL_Texture* texture;
+} TextureEntry;
+
+static TextureEntry textures[RESOURCE_MAX_TEXTURES];
+static int live_textures = 0;
+static size_t live_bytes = 0;
+
+static TextureEntry* find_key(const char* key) {
+    for (int i = 0; i < RESOURCE_MAX_TEXTURES; i++) {
+        if (textures[i].refs > 0 && strcmp(textures[i].key, key) == 0) {
+            return &textures[i];
+        }
+    }
+    return NULL;
+}
+
+static TextureEntry* find_texture(SDL_Texture* texture) {
+    for (int i = 0; i < RESOURCE_MAX_TEXTURES; i++) {
+        if (textures[i].refs > 0 && textures[i].texture == texture) {
+            return &textures[i];
+        }
+    }
+    return NULL;
+}
+
+// Size of the pixels as uploaded, the driver may pad it a bit
+static size_t texture_bytes(SDL_Texture* texture) {
+    Uint32 format;
+    int w, h;
+    if (SDL_QueryTexture(texture, &format, NULL, &w, &h) != 0) {
+        return 0;
+    }
+    return (size_t)w * h * SDL_BYTESPERPIXEL(format);
+}
+
+SDL_Texture* resource_texture_acquire(const char* key) {
+    TextureEntry* entry = find_key(key);
+    if (!entry) {
+        return NULL;
+    }
+    entry->refs++;
+    return entry->texture;
+}
+
+SDL_Texture* resource_texture_add(const char* key, SDL_Texture* texture) {
+    if (!texture) {
+        return NULL;
+    }
+    if (find_key(key)) {
+        fprintf(stderr, "Resources: %s is already cached, acquire it instead\n", key);
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+
+    TextureEntry* entry = NULL;
+    for (int i = 0; i < RESOURCE_MAX_TEXTURES; i++) {
+        if (textures[i].refs == 0) {
+            entry = &textures[i];
+            break;
+        }
+    }
+    if (!entry) {
+        fprintf(stderr, "Resources: too many textures, can't keep %s\n", key);
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+
+    snprintf(entry->key, sizeof(entry->key), "%s", key);
+    entry->refs = 1;
+    entry->texture = texture;
+    entry->bytes = texture_bytes(texture);
+
+    live_textures++;
+    live_bytes += entry->bytes;
+    return texture;
+}
+
+void resource_release(SDL_Texture* texture) {
+    if (!texture) {
+        return;
+    }
+
+    TextureEntry* entry = find_texture(texture);
+    if (!entry) {
+        fprintf(stderr, "Resources: releasing a texture the cache doesn't own\n");
+        return;
+    }
+
+    if (--entry->refs == 0) {
+        SDL_DestroyTexture(entry->texture);
+        live_textures--;
+        live_bytes -= entry->bytes;
+        memset(entry, 0, sizeof(*entry));
+    }
+}
+
+int resource_texture_count() {
+    return live_textures;
+}
+
+size_t resource_texture_bytes() {
+    return live_bytes;
+}
+
+void resource_shutdown() {
+    for (int i = 0; i < RESOURCE_MAX_TEXTURES; i++) {
+        TextureEntry* entry = &textures[i];
+        if (entry->refs == 0) continue;
+
+        fprintf(stderr, "Resources: %s still has %d reference(s)\n", entry->key, entry->refs);
+        SDL_DestroyTexture(entry->texture);
+        memset(entry, 0, sizeof(*entry));
+    }
+    live_textures = 0;
+    live_bytes = 0;
+}
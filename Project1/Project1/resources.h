@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <SDL.h>
+
+// Limits for the resource cache
+#define RESOURCE_MAX_TEXTURES 32
+#define RESOURCE_MAX_KEY_LENGTH 260
+
+// Reference counted texture cache keyed by asset name (the sprite atlas, a font file at a size).
+// Every texture the game keeps alive goes through here, so the totals below show
+// whether GPU memory stays flat across levels.
+
+// Returns the texture cached under key with a new reference, or NULL if it isn't built yet.
+// Callers try this first and only build and add the texture when it misses.
+SDL_Texture* resource_texture_acquire(const char* key);
+
+// Takes ownership of a texture built by the caller (atlases), with one reference
+SDL_Texture* resource_texture_add(const char* key, SDL_Texture* texture);
+
+// Drops a reference, the texture is destroyed when the last one goes
+void resource_release(SDL_Texture* texture);
+
+// Live textures and the bytes their pixels take
+int resource_texture_count();
+size_t resource_texture_bytes();
+
+// Destroys whatever is left and reports it as leaked. Call before SDL_DestroyRenderer.
+void resource_shutdown();
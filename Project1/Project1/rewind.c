@@ -0,0 +1,208 @@
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Other_includes
+#include "rewind.h"
+
+int rewind_init(Rewind* history, const GameConfig* config, size_t bytes, int max_ticks) {
+    memset(history, 0, sizeof(*history));
+    if (max_ticks < 1) max_ticks = 1;
+
+    // An entry can take a little more than its image when nothing matches the keyframe
+    size_t max_image = game_state_max_size(config);
+    size_t worst_entry = max_image + max_image / 64 + 16;
+    if (bytes < worst_entry * 2) bytes = worst_entry * 2;
+
+    history->memory = malloc(bytes + sizeof(RewindEntry) * max_ticks + max_image * 2);
+    if (!history->memory) {
+        fprintf(stderr, "Error: Could not allocate %zu bytes of rewind history\n", bytes);
+        return FALSE;
+    }
+
+    unsigned char* p = history->memory;
+    history->entries = (RewindEntry*)p; p += sizeof(RewindEntry) * max_ticks;
+    history->image = p; p += max_image;
+    history->key = p; p += max_image;
+    history->data = p;
+    history->data_size = bytes;
+    history->max_entries = max_ticks;
+    history->max_image = max_image;
+    history->since_key = -1;
+    return TRUE;
+}
+
+void rewind_free(Rewind* history) {
+    free(history->memory);
+    memset(history, 0, sizeof(*history));
+}
+
+void rewind_clear(Rewind* history) {
+    history->first = 0;
+    history->count = 0;
+    history->data_head = 0;
+    history->since_key = -1;
+}
+
+int rewind_tick_count(const Rewind* history) {
+    return (int)history->count;
+}
+
+size_t rewind_used_bytes(const Rewind* history) {
+    size_t used = 0;
+    for (unsigned int n = 0; n < history->count; n++) {
+        used += history->entries[(history->first + n) % history->max_entries].size;
+    }
+    return used;
+}
+
+static RewindEntry* entry_at(const Rewind* history, unsigned int serial) {
+    return &history->entries[serial % history->max_entries];
+}
+
+static void write_varint(unsigned char** p, size_t value) {
+    while (value >= 0x80) {
+        *(*p)++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *(*p)++ = (unsigned char)value;
+}
+
+static size_t read_varint(const unsigned char** p) {
+    size_t value = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+        byte = *(*p)++;
+        value |= (size_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+// image XOR base (zeros past base_size) as (zero run, literal run, literal bytes) triples.
+// Literal runs only end at 4 zero bytes or more, shorter gaps cost more to encode than to copy.
+static size_t encode(const unsigned char* image, size_t size, const unsigned char* base, size_t base_size, unsigned char* out) {
+    unsigned char* p = out;
+    size_t i = 0;
+    while (i < size) {
+        size_t zeros_start = i;
+        while (i < size && (image[i] ^ (i < base_size ? base[i] : 0)) == 0) i++;
+        size_t zeros = i - zeros_start;
+
+        size_t literal_start = i;
+        size_t run = 0;
+        while (i < size && run < 4) {
+            run = (image[i] ^ (i < base_size ? base[i] : 0)) == 0 ? run + 1 : 0;
+            i++;
+        }
+        if (run == 4) i -= 4;
+        size_t literals = i - literal_start;
+
+        write_varint(&p, zeros);
+        write_varint(&p, literals);
+        for (size_t k = literal_start; k < i; k++) {
+            *p++ = image[k] ^ (k < base_size ? base[k] : 0);
+        }
+    }
+    return (size_t)(p - out);
+}
+
+// XORs an encoded entry into image, which starts as its base
+static void decode(const unsigned char* data, size_t size, unsigned char* image) {
+    const unsigned char* p = data;
+    const unsigned char* end = data + size;
+    size_t i = 0;
+    while (p < end) {
+        i += read_varint(&p);
+        size_t literals = read_varint(&p);
+        for (size_t k = 0; k < literals; k++) {
+            image[i++] ^= *p++;
+        }
+    }
+}
+
+// Drops the oldest keyframe and every delta made against it
+static void drop_oldest(Rewind* history) {
+    do {
+        history->first++;
+        history->count--;
+    } while (history->count > 0 && entry_at(history, history->first)->keyframe != history->first);
+}
+
+void rewind_record(Rewind* history, const Game* game, unsigned int tick) {
+    size_t image_size = game_save_state(game, history->image);
+
+    // Worst case for the entry, it never wraps around the end of the ring
+    size_t worst = image_size + image_size / 64 + 16;
+    if (history->data_head + worst > history->data_size) {
+        history->data_head = 0;
+    }
+
+    // Older entries in the way go first, they're the ones right after the head
+    while (history->count > 0) {
+        const RewindEntry* oldest = entry_at(history, history->first);
+        int overlaps = oldest->offset < history->data_head + worst && history->data_head < oldest->offset + oldest->size;
+        if (!overlaps && history->count < (unsigned int)history->max_entries) break;
+        drop_oldest(history);
+    }
+
+    // New keyframe on schedule, or when the last one just made room for this entry
+    unsigned int serial = history->first + history->count;
+    int key_dropped = history->count == 0 || (int)(history->key_serial - history->first) < 0;
+    int keyframe = key_dropped || history->since_key < 0 || history->since_key >= REWIND_KEYFRAME_INTERVAL;
+    if (keyframe) {
+        memcpy(history->key, history->image, image_size);
+        history->key_size = image_size;
+        history->key_serial = serial;
+        history->since_key = 0;
+    }
+
+    // A keyframe is encoded against nothing, so only its zero bytes are squeezed out
+    unsigned char* out = history->data + history->data_head;
+    size_t size = keyframe ?
+        encode(history->image, image_size, NULL, 0, out) :
+        encode(history->image, image_size, history->key, history->key_size, out);
+
+    RewindEntry* entry = entry_at(history, serial);
+    entry->tick = tick;
+    entry->offset = history->data_head;
+    entry->size = size;
+    entry->image_size = image_size;
+    entry->keyframe = history->key_serial;
+
+    history->count++;
+    history->data_head += size;
+    history->since_key++;
+}
+
+long rewind_restore(Rewind* history, Game* game, int ticks_back) {
+    if (history->count == 0) {
+        return -1;
+    }
+    if (ticks_back < 0) ticks_back = 0;
+    if ((unsigned int)ticks_back >= history->count) ticks_back = (int)history->count - 1;
+
+    unsigned int serial = history->first + history->count - 1 - (unsigned int)ticks_back;
+    const RewindEntry* entry = entry_at(history, serial);
+    const RewindEntry* key = entry_at(history, entry->keyframe);
+
+    // Keyframe into the scratch image, then the delta on top
+    size_t size = key->image_size > entry->image_size ? key->image_size : entry->image_size;
+    memset(history->image, 0, size);
+    decode(history->data + key->offset, key->size, history->image);
+    if (entry != key) {
+        decode(history->data + entry->offset, entry->size, history->image);
+    }
+
+    if (!game_load_state(game, history->image, entry->image_size)) {
+        return -1;
+    }
+
+    // History continues from here, the next tick starts a new keyframe
+    history->count = serial - history->first + 1;
+    history->data_head = entry->offset + entry->size;
+    history->since_key = -1;
+    return (long)entry->tick;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// Rewind history: a state image (game_save_state()) after every tick, kept in a fixed
+// byte ring. Every REWIND_KEYFRAME_INTERVAL ticks the image is stored whole, the ticks in
+// between only store how they differ from that keyframe: the bytes are XORed with it and
+// the runs of zeros (everything that didn't change) are dropped. Restoring any tick is one
+// keyframe plus one delta, however far back it is. When the ring is full the oldest
+// keyframe goes, with the deltas that needed it.
+//
+// No SDL in here, the sim thread owns it like the game.
+
+#include <stddef.h>
+
+#include "game.h"
+
+#define REWIND_KEYFRAME_INTERVAL 60
+#define REWIND_DEFAULT_BYTES (4 * 1024 * 1024)
+
+typedef struct {
+    unsigned int tick;
+    size_t offset;          // Encoded bytes in the ring
+    size_t size;
+    size_t image_size;      // Bytes once decoded
+    unsigned int keyframe;  // Entry serial of its keyframe, its own for keyframes
+} RewindEntry;
+
+typedef struct {
+    unsigned char* data;    // Byte ring of encoded entries, an entry never wraps
+    size_t data_size;
+    size_t data_head;       // Where the next entry goes
+
+    RewindEntry* entries;   // Ring indexed by serial % max_entries
+    int max_entries;
+    unsigned int first;     // Serial of the oldest entry
+    unsigned int count;
+
+    unsigned char* image;   // Scratch for the image being saved / restored
+    unsigned char* key;     // Image of the newest keyframe, deltas are made against it
+    size_t key_size;
+    size_t max_image;
+    unsigned int key_serial;
+    int since_key;          // Ticks stored since the newest keyframe, -1 forces one
+
+    void* memory;           // Backs everything above
+} Rewind;
+
+// bytes is the size of the ring, max_ticks the most ticks it can hold whatever their size
+int rewind_init(Rewind* history, const GameConfig* config, size_t bytes, int max_ticks);  // Returns FALSE on failure
+void rewind_free(Rewind* history);
+void rewind_clear(Rewind* history);    // Forgets every tick, for a new game
+
+// Stores the game as it is after tick
+void rewind_record(Rewind* history, const Game* game, unsigned int tick);
+
+// Puts the game back ticks_back ticks before the newest one (0 is the newest) and forgets
+// everything after it. Goes as far as the history reaches, returns the tick it got to or -1.
+long rewind_restore(Rewind* history, Game* game, int ticks_back);
+
+// Ticks held, and bytes the entries take in the ring
+int rewind_tick_count(const Rewind* history);
+size_t rewind_used_bytes(const Rewind* history);
@@ -0,0 +1,52 @@
+// Other_includes
+#include "rng.h"
+
+#define PCG_MULTIPLIER 6364136223846793005ull
+
+void rng_seed(Rng* rng, uint64_t seed, uint64_t stream) {
+    // Same as the reference pcg32_srandom_r
+    rng->state = 0;
+    rng->inc = (stream << 1) | 1u;
+    rng_next(rng);
+    rng->state += seed;
+    rng_next(rng);
+}
+
+uint32_t rng_next(Rng* rng) {
+    uint64_t old = rng->state;
+    rng->state = old * PCG_MULTIPLIER + rng->inc;
+
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31));
+}
+
+// Lemire's multiply and shift, only the rare low products below the threshold are drawn again
+uint32_t rng_below(Rng* rng, uint32_t bound) {
+    uint64_t m = (uint64_t)rng_next(rng) * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            m = (uint64_t)rng_next(rng) * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// Top 24 bits, every value is exact in a float
+float rng_float(Rng* rng) {
+    return (rng_next(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+float rng_range(Rng* rng, float low, float high) {
+    return low + (high - low) * rng_float(rng);
+}
+
+void rng_fill_int(Rng* rng, float* out, int count, int low, int high) {
+    uint32_t bound = high > low ? (uint32_t)(high - low) : 1u;
+    for (int i = 0; i < count; i++) {
+        out[i] = (float)(low + (int)rng_below(rng, bound));
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// Random number streams, PCG32 (a 64 bit LCG with a permuted 32 bit output).
+// Every stream is its own struct, nothing global, so threads and subsystems never share
+// state, and the numbers are the same on every platform and compiler. The seed and the
+// stream id pick the sequence: streams with the same seed and different ids don't overlap,
+// so each subsystem draws from its own and more draws in one never shift another.
+
+#include <stdint.h>
+
+// Stream ids
+enum {
+    RNG_STREAM_SPAWN,       // Egg positions and gravity, part of the simulation
+    RNG_STREAM_PARTICLES,   // Effects, render thread only
+    RNG_STREAM_INPUT        // Synthetic input for the latency mode, render thread only
+};
+
+typedef struct {
+    uint64_t state;
+    uint64_t inc;           // Odd, picked by the stream id
+} Rng;
+
+void rng_seed(Rng* rng, uint64_t seed, uint64_t stream);
+
+uint32_t rng_next(Rng* rng);
+
+// 0 .. bound - 1 without the modulo bias, bound > 0
+uint32_t rng_below(Rng* rng, uint32_t bound);
+
+// [0, 1) and [low, high)
+float rng_float(Rng* rng);
+float rng_range(Rng* rng, float low, float high);
+
+// Batch, one call fills a whole array (e.g. the eggs spawned this tick) with whole numbers in [low, high)
+void rng_fill_int(Rng* rng, float* out, int count, int low, int high);
@@ -0,0 +1,191 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+
+// Other_includes
+#include "constants.h"
+#include "scene.h"
+
+// Fonts the HUD asks for, a backend without one falls back to its default
+#define HUD_FONT "assets/Pixeltype.ttf"
+#define GAME_OVER_HINT_FONT "C:\\Users\\Paracite\\Desktop\\C Projects\\Project1\\Project1\\Minecraft.ttf"
+
+// Bursts per event
+#define SPLAT_PARTICLES 12
+#define CATCH_PARTICLES 10
+#define LEVEL_UP_PARTICLES 60
+
+// Sprite for each kind of particle
+static const int particle_sprites[PARTICLE_KINDS] = { SPRITE_REMAINS, SPRITE_GOLDEN_EGG };
+
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+static SceneColor rgba(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    SceneColor color = { r, g, b, a };
+    return color;
+}
+
+void scene_copy(Snapshot* snapshot, const Game* game, int capacity) {
+    const Eggs* eggs = &game->eggs;
+
+    snapshot->ball = game->ball;
+    snapshot->block = game->block;
+    snapshot->chicken = game->chicken;
+    snapshot->chicken_facing = game->chicken_facing;
+    snapshot->ground = game->ground;
+    snapshot->is_game_over = game->is_game_over;
+    snapshot->current_level = game->current_level;
+    snapshot->collected_objects = game->collected_objects;
+    snapshot->to_collect = game->to_collect;
+
+    int count = eggs->count < capacity ? eggs->count : capacity;
+    size_t bytes = sizeof(float) * count;
+    memcpy(snapshot->prev_x, eggs->prev_x, bytes);
+    memcpy(snapshot->prev_y, eggs->prev_y, bytes);
+    memcpy(snapshot->x, eggs->x, bytes);
+    memcpy(snapshot->y, eggs->y, bytes);
+    memcpy(snapshot->width, eggs->width, bytes);
+    memcpy(snapshot->height, eggs->height, bytes);
+    snapshot->egg_count = count;
+}
+
+void scene_emit_particles(Particles* particles, const GameEvent* events, int num_events) {
+    for (int i = 0; i < num_events; i++) {
+        const GameEvent* event = &events[i];
+        switch (event->type) {
+        case GAME_EVENT_SPLAT:
+            particles_emit(particles, PARTICLE_SHELL, event->x, event->y, SPLAT_PARTICLES);
+            break;
+        case GAME_EVENT_CATCH:
+            particles_emit(particles, PARTICLE_SPARKLE, event->x, event->y, CATCH_PARTICLES);
+            break;
+        case GAME_EVENT_LEVEL_UP:
+            particles_emit(particles, PARTICLE_SPARKLE, event->x, event->y, LEVEL_UP_PARTICLES);
+            break;
+        }
+    }
+}
+
+void scene_draw_background(const Canvas* canvas) {
+    canvas->sprite(canvas->context, SPRITE_BACKGROUND, NULL, rgba(255, 255, 255, 255), FALSE);
+}
+
+void scene_draw_world(const Canvas* canvas, const Snapshot* view, float alpha, const Particles* particles) {
+    const SceneColor white = { 255, 255, 255, 255 };
+
+    scene_draw_background(canvas);
+
+    // Draw a ball rect
+    SceneRect ball_rect = {
+        (int)lerp(view->ball.prev_x, view->ball.x, alpha),
+        (int)lerp(view->ball.prev_y, view->ball.y, alpha),
+        (int)view->ball.width,
+        (int)view->ball.height
+    };
+    canvas->sprite(canvas->context, SPRITE_BAG, &ball_rect, white, FALSE);
+
+    // Draw a block rect, the frames aren't all the same size so each one keeps its shape,
+    // as tall as the chicken and standing on its bottom edge
+    SceneRect block_rect = {
+        (int)lerp(view->block.prev_x, view->block.x, alpha),
+        (int)lerp(view->block.prev_y, view->block.y, alpha),
+        (int)view->block.width,
+        (int)view->block.height
+    };
+    int chicken_sprite = SPRITE_CHICKEN + anim_frame(&view->chicken);
+    int frame_width, frame_height;
+    canvas->sprite_size(canvas->context, chicken_sprite, &frame_width, &frame_height);
+    SceneRect chicken_rect = block_rect;
+    if (frame_height > 0) {
+        chicken_rect.w = frame_width * block_rect.h / frame_height;
+        chicken_rect.x = block_rect.x + (block_rect.w - chicken_rect.w) / 2;
+    }
+    // The running frames face left, psychic tints the chicken purple
+    SceneColor chicken_color = white;
+    if (view->chicken.clip == ANIM_PSYCHIC) {
+        chicken_color.r = 200;
+        chicken_color.g = 140;
+    }
+    canvas->sprite(canvas->context, chicken_sprite, &chicken_rect, chicken_color, view->chicken_facing > 0);
+
+    // Draw Ground Rect
+    SceneRect ground_rect = {
+        (int)view->ground.x,
+        (int)view->ground.y,
+        (int)view->ground.width,
+        (int)view->ground.height
+    };
+    canvas->fill(canvas->context, &ground_rect, rgba(135, 42, 32, 255));
+
+    // Only active eggs are stored, so there's nothing to skip
+    for (int i = 0; i < view->egg_count; i++) {
+        SceneRect obj_rect = {
+            (int)lerp(view->prev_x[i], view->x[i], alpha),
+            (int)lerp(view->prev_y[i], view->y[i], alpha),
+            (int)view->width[i],
+            (int)view->height[i]
+        };
+        canvas->sprite(canvas->context, SPRITE_EGG, &obj_rect, white, FALSE);
+    }
+
+    // Particles go in the same batch, fading out over their life
+    if (!particles) {
+        return;
+    }
+    int num_particles = particles_count(particles);
+    for (int n = 0; n < num_particles; n++) {
+        int i = particles_slot(particles, n);
+        float left = 1.0f - particles->age[i] / particles->life[i];
+        if (left <= 0.0f) continue;
+
+        // Size is the width, the height keeps the sprite's shape
+        int sprite = particle_sprites[particles->kind[i]];
+        int sprite_width, sprite_height;
+        canvas->sprite_size(canvas->context, sprite, &sprite_width, &sprite_height);
+        int width = (int)particles->size[i];
+        int height = sprite_width > 0 ? width * sprite_height / sprite_width : width;
+        SceneRect particle_rect = {
+            (int)particles->x[i] - width / 2,
+            (int)particles->y[i] - height / 2,
+            width,
+            height
+        };
+        canvas->sprite(canvas->context, sprite, &particle_rect, rgba(255, 255, 255, (unsigned char)(255.0f * left)), FALSE);
+    }
+}
+
+void scene_draw_hud(const Canvas* canvas, const Snapshot* view) {
+    // Render level and collected objects information
+    char level_text[50];
+    char objects_text[50];
+
+    snprintf(level_text, sizeof(level_text), "LEVEL: %d", view->current_level);
+    snprintf(objects_text, sizeof(objects_text), "EGGS: %d/%d", view->collected_objects, view->to_collect);
+
+    canvas->text(canvas->context, HUD_FONT, 24, level_text, 90, 50, rgba(255, 255, 255, 255));
+    canvas->text(canvas->context, HUD_FONT, 24, objects_text, 100, 80, rgba(255, 255, 255, 255));
+}
+
+// Pause Screen, drawn over the frozen scene
+void scene_draw_paused(const Canvas* canvas) {
+    canvas->text(canvas->context, HUD_FONT, 36, "PAUSED - PRESS P TO CONTINUE",
+        WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2, rgba(255, 255, 255, 255));
+}
+
+// Game Over Screen, over the background
+void scene_draw_game_over(const Canvas* canvas, const Snapshot* view) {
+    char game_over_text[100];
+    snprintf(game_over_text, sizeof(game_over_text), "GAME OVER - LEVEL %d", view->current_level);
+
+    // Game Over text with original font
+    canvas->text(canvas->context, HUD_FONT, 36, game_over_text,
+        WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 - 100, rgba(255, 255, 255, 255));
+
+    // Restart instructions with a different font
+    canvas->text(canvas->context, GAME_OVER_HINT_FONT, 24, "PRESS ENTER TO RESTART",
+        WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 + 50, rgba(200, 200, 200, 255));
+}
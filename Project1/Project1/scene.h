@@ -0,0 +1,78 @@
+#pragma once
+
+// What a frame shows and how it's drawn. No SDL in here: render() in main.c and the headless
+// renderer in raster.c draw the same frames through scene_draw_*(), which only talk to a Canvas,
+// a table of sprite / fill / text calls the backend fills in. main.c's canvas batches into the
+// sprite atlas and the glyph cache, raster.c's draws into memory with no GPU or window.
+//
+// Everything is in game units, WINDOW_WIDTH x WINDOW_HEIGHT, whatever size the backend draws at.
+
+#include "assets.h"
+#include "game.h"
+#include "particles.h"
+
+// What the render thread needs from the game, snapshot.h passes them between the threads
+typedef struct {
+    Ball ball;
+    Block block;
+    Floor ground;
+    Animator chicken;
+    int chicken_facing;
+
+    int is_game_over;
+    int current_level;
+    int collected_objects;
+    int to_collect;
+
+    // Effects from the ticks since the last snapshot the render thread read
+    GameEvent events[GAME_MAX_EVENTS];
+    int num_events;
+    unsigned int serial;    // Goes up with every capture, so the render thread knows what's new
+
+    // Active eggs, at the previous and the last tick for interpolation
+    int egg_count;
+    float* prev_x;
+    float* prev_y;
+    float* x;
+    float* y;
+    float* width;
+    float* height;
+
+    double time;        // Seconds (performance counter) when the last tick finished
+
+    // Newest input probe a tick has run with, and when that tick finished (latency.h)
+    unsigned int input_probe;
+    double input_probe_time;
+} Snapshot;
+
+typedef struct {
+    int x, y, w, h;
+} SceneRect;
+
+typedef struct {
+    unsigned char r, g, b, a;
+} SceneColor;
+
+typedef struct {
+    void* context;
+    void (*sprite)(void* context, int sprite, const SceneRect* dst, SceneColor color, int flip_x);  // NULL dst fills the screen
+    void (*fill)(void* context, const SceneRect* dst, SceneColor color);
+    void (*text)(void* context, const char* font_path, int font_size, const char* text, int x, int y, SceneColor color);  // Centered on (x, y)
+    void (*sprite_size)(void* context, int sprite, int* width, int* height);
+} Canvas;
+
+// Copies the game's state into a snapshot with room for capacity eggs. Events, serial, time
+// and the input probe are left to the caller.
+void scene_copy(Snapshot* snapshot, const Game* game, int capacity);
+
+// Bursts of particles for the game's events
+void scene_emit_particles(Particles* particles, const GameEvent* events, int num_events);
+
+// The world, drawn back to front. alpha blends between the previous and the last tick (0..1).
+void scene_draw_world(const Canvas* canvas, const Snapshot* view, float alpha, const Particles* particles);
+void scene_draw_background(const Canvas* canvas);
+
+// Text on top of the world
+void scene_draw_hud(const Canvas* canvas, const Snapshot* view);
+void scene_draw_paused(const Canvas* canvas);
+void scene_draw_game_over(const Canvas* canvas, const Snapshot* view);
@@ -0,0 +1,89 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// User_defined_library
+#include <SDL.h>
+
+// Other_includes
+#include "constants.h"
+#include "snapshot.h"
+
+// Set in middle when the slot there hasn't been read yet, the low bits are the slot index
+#define SNAPSHOT_FRESH 4
+#define SNAPSHOT_SLOT_MASK 3
+
+// Egg arrays per slot
+#define SNAPSHOT_ARRAYS 6
+
+int snapshot_buffer_init(SnapshotBuffer* buffer, int capacity) {
+    memset(buffer, 0, sizeof(*buffer));
+
+    size_t array_bytes = sizeof(float) * capacity;
+    buffer->memory = malloc(array_bytes * SNAPSHOT_ARRAYS * 3);
+    if (!buffer->memory) {
+        fprintf(stderr, "Error: Could not allocate snapshots for %d objects\n", capacity);
+        return FALSE;
+    }
+    buffer->capacity = capacity;
+
+    float* p = buffer->memory;
+    for (int s = 0; s < 3; s++) {
+        Snapshot* snapshot = &buffer->slots[s];
+        snapshot->prev_x = p; p += capacity;
+        snapshot->prev_y = p; p += capacity;
+        snapshot->x = p; p += capacity;
+        snapshot->y = p; p += capacity;
+        snapshot->width = p; p += capacity;
+        snapshot->height = p; p += capacity;
+    }
+
+    // Writer starts on 0, the middle holds 1 (nothing to read yet), the reader shows 2
+    buffer->back = 0;
+    SDL_AtomicSet(&buffer->middle, 1);
+    buffer->front = 2;
+    return TRUE;
+}
+
+void snapshot_buffer_free(SnapshotBuffer* buffer) {
+    free(buffer->memory);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+void snapshot_capture(SnapshotBuffer* buffer, Game* game, double time) {
+    Snapshot* snapshot = &buffer->slots[buffer->back];
+
+    scene_copy(snapshot, game, buffer->capacity);
+    snapshot->time = time;
+    snapshot->input_probe = buffer->input_probe;
+    snapshot->input_probe_time = buffer->input_probe_time;
+
+    // A slot the render thread skipped still holds events it never saw, add the new ones after them
+    if (!buffer->back_unread) {
+        snapshot->num_events = 0;
+    }
+    int room = GAME_MAX_EVENTS - snapshot->num_events;
+    int num_events = game->num_events < room ? game->num_events : room;
+    memcpy(snapshot->events + snapshot->num_events, game->events, sizeof(GameEvent) * num_events);
+    snapshot->num_events += num_events;
+    snapshot->serial = ++buffer->serial;
+    game_clear_events(game);
+
+    // Everything above must be visible before the slot is handed over
+    SDL_MemoryBarrierRelease();
+    int old = SDL_AtomicSet(&buffer->middle, buffer->back | SNAPSHOT_FRESH);
+    buffer->back = old & SNAPSHOT_SLOT_MASK;
+    buffer->back_unread = (old & SNAPSHOT_FRESH) != 0;
+}
+
+const Snapshot* snapshot_acquire(SnapshotBuffer* buffer) {
+    if (SDL_AtomicGet(&buffer->middle) & SNAPSHOT_FRESH) {
+        int old = SDL_AtomicSet(&buffer->middle, buffer->front);
+        SDL_MemoryBarrierAcquire();
+        buffer->front = old & SNAPSHOT_SLOT_MASK;
+    }
+    return &buffer->slots[buffer->front];
+}
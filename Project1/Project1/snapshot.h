@@ -0,0 +1,34 @@
+#pragma once
+
+// Snapshots (scene.h) of the game, copied out by the sim thread after its ticks. They go
+// through a triple buffer: the sim thread fills the back slot and swaps it with the middle
+// one, the render thread swaps the middle one with its front slot when there's something new.
+// Neither side ever waits for the other, and the render thread always gets the newest
+// complete snapshot.
+
+#include <SDL.h>
+
+#include "scene.h"
+
+typedef struct {
+    Snapshot slots[3];
+    void* memory;       // Backs the egg arrays of all three slots
+    int capacity;
+
+    SDL_atomic_t middle; // Slot between the two threads, SNAPSHOT_FRESH is set until the reader takes it
+    int back;           // Sim thread only
+    int back_unread;    // Sim thread only, the slot it got back was never read, so its events still count
+    unsigned int serial;
+    unsigned int input_probe;   // Sim thread only, copied into every capture
+    double input_probe_time;
+    int front;          // Render thread only
+} SnapshotBuffer;
+
+int snapshot_buffer_init(SnapshotBuffer* buffer, int capacity);  // Returns FALSE on failure
+void snapshot_buffer_free(SnapshotBuffer* buffer);
+
+// Sim thread: copy the game into the back slot, then publish it. Takes the game's events.
+void snapshot_capture(SnapshotBuffer* buffer, Game* game, double time);
+
+// Render thread: newest published snapshot, the same one again if nothing new came in
+const Snapshot* snapshot_acquire(SnapshotBuffer* buffer);
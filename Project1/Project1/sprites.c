@@ -0,0 +1,263 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// User_defined_library
+#include <SDL.h>
+
+// Other_includes
+#include "constants.h"
+#include "sprites.h"
+#include "resources.h"
+
+// Smallest atlas width, grows to fit the widest sprite. Rows are packed top to bottom.
+#define ATLAS_MIN_WIDTH 1024
+#define ATLAS_PADDING 1
+
+// Name of the atlas in the resource cache
+#define ATLAS_KEY "sprites:atlas"
+
+// Quads the vertex buffer starts with, it doubles when a frame needs more
+#define INITIAL_QUADS 256
+
+typedef struct {
+    SDL_Rect src;           // Where the sprite sits inside the atlas
+    float u0, v0, u1, v1;   // Same rect in texture coordinates
+} Sprite;
+
+static Sprite sprites[SPRITE_COUNT];
+static SDL_Texture* atlas = NULL;
+
+// Quads queued since sprites_begin()
+static SDL_Vertex* vertices = NULL;
+static int* indices = NULL;
+static int max_quads = 0;
+static int num_quads = 0;
+
+static void free_surfaces(SDL_Surface** surfaces) {
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        SDL_FreeSurface(surfaces[i]);
+        surfaces[i] = NULL;
+    }
+}
+
+int sprites_build(SDL_Renderer* renderer, SDL_Surface** surfaces) {
+    if (atlas) {
+        free_surfaces(surfaces);
+        return TRUE;
+    }
+
+    // Still cached from an earlier build, the rects below are from that build too
+    atlas = resource_texture_acquire(ATLAS_KEY);
+    if (atlas) {
+        free_surfaces(surfaces);
+        return TRUE;
+    }
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (assets_sprite_file(i)) {
+            if (!surfaces[i]) {
+                free_surfaces(surfaces);
+                return FALSE;
+            }
+        }
+        else {
+            surfaces[i] = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32);
+            if (!surfaces[i]) {
+                fprintf(stderr, "SDL_CreateRGBSurfaceWithFormat: %s\n", SDL_GetError());
+                free_surfaces(surfaces);
+                return FALSE;
+            }
+            SDL_FillRect(surfaces[i], NULL, SDL_MapRGBA(surfaces[i]->format, 255, 255, 255, 255));
+        }
+    }
+
+    // First pass: shelf-pack the rects
+    int atlas_width = ATLAS_MIN_WIDTH;
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (surfaces[i]->w + ATLAS_PADDING * 2 > atlas_width) {
+            atlas_width = surfaces[i]->w + ATLAS_PADDING * 2;
+        }
+    }
+
+    int pen_x = ATLAS_PADDING;
+    int pen_y = ATLAS_PADDING;
+    int row_height = 0;
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        int w = surfaces[i]->w;
+        int h = surfaces[i]->h;
+        if (pen_x + w + ATLAS_PADDING > atlas_width) {
+            pen_x = ATLAS_PADDING;
+            pen_y += row_height + ATLAS_PADDING;
+            row_height = 0;
+        }
+
+        sprites[i].src.x = pen_x;
+        sprites[i].src.y = pen_y;
+        sprites[i].src.w = w;
+        sprites[i].src.h = h;
+
+        pen_x += w + ATLAS_PADDING;
+        if (h > row_height) row_height = h;
+    }
+
+    int atlas_height = pen_y + row_height + ATLAS_PADDING;
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0 &&
+        ((info.max_texture_width && atlas_width > info.max_texture_width) ||
+         (info.max_texture_height && atlas_height > info.max_texture_height))) {
+        fprintf(stderr, "Sprite atlas is %dx%d, the renderer only supports %dx%d\n",
+            atlas_width, atlas_height, info.max_texture_width, info.max_texture_height);
+        free_surfaces(surfaces);
+        return FALSE;
+    }
+
+    // Second pass: copy the sprites into a single surface and upload it once
+    SDL_Surface* atlas_surface = SDL_CreateRGBSurfaceWithFormat(0, atlas_width, atlas_height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlas_surface) {
+        fprintf(stderr, "SDL_CreateRGBSurfaceWithFormat: %s\n", SDL_GetError());
+        free_surfaces(surfaces);
+        return FALSE;
+    }
+
+    float inv_w = 1.0f / atlas_width;
+    float inv_h = 1.0f / atlas_height;
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        // Copy alpha as-is instead of blending onto the empty atlas
+        SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+        SDL_Rect dst = sprites[i].src;
+        SDL_BlitSurface(surfaces[i], NULL, atlas_surface, &dst);
+
+        Sprite* sprite = &sprites[i];
+        sprite->u0 = sprite->src.x * inv_w;
+        sprite->v0 = sprite->src.y * inv_h;
+        sprite->u1 = (sprite->src.x + sprite->src.w) * inv_w;
+        sprite->v1 = (sprite->src.y + sprite->src.h) * inv_h;
+    }
+    free_surfaces(surfaces);
+
+    // Solid fills sample the middle of the white texel so filtering never reaches the neighbours
+    Sprite* white = &sprites[SPRITE_WHITE];
+    white->u0 = white->u1 = (white->src.x + 0.5f) * inv_w;
+    white->v0 = white->v1 = (white->src.y + 0.5f) * inv_h;
+
+    atlas = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+    SDL_FreeSurface(atlas_surface);
+    if (!atlas) {
+        fprintf(stderr, "SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
+        return FALSE;
+    }
+    atlas = resource_texture_add(ATLAS_KEY, atlas);
+    if (!atlas) {
+        return FALSE;
+    }
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+
+    return TRUE;
+}
+
+void sprites_size(int sprite, int* width, int* height) {
+    if (width) *width = sprites[sprite].src.w;
+    if (height) *height = sprites[sprite].src.h;
+}
+
+// Grows the buffers so that quads fit, the indices (0 1 2, 2 1 3 per quad) never change
+static int reserve(int quads) {
+    if (quads <= max_quads) {
+        return TRUE;
+    }
+
+    int new_max = max_quads ? max_quads : INITIAL_QUADS;
+    while (new_max < quads) new_max *= 2;
+
+    SDL_Vertex* new_vertices = realloc(vertices, sizeof(SDL_Vertex) * 4 * new_max);
+    if (!new_vertices) return FALSE;
+    vertices = new_vertices;
+
+    int* new_indices = realloc(indices, sizeof(int) * 6 * new_max);
+    if (!new_indices) return FALSE;
+    indices = new_indices;
+
+    for (int i = max_quads; i < new_max; i++) {
+        indices[i * 6 + 0] = i * 4 + 0;
+        indices[i * 6 + 1] = i * 4 + 1;
+        indices[i * 6 + 2] = i * 4 + 2;
+        indices[i * 6 + 3] = i * 4 + 2;
+        indices[i * 6 + 4] = i * 4 + 1;
+        indices[i * 6 + 5] = i * 4 + 3;
+    }
+    max_quads = new_max;
+    return TRUE;
+}
+
+static void add_quad(const Sprite* sprite, const SDL_Rect* dst, SDL_Color color, int flip_x) {
+    if (!reserve(num_quads + 1)) {
+        return;
+    }
+
+    float x0 = 0, y0 = 0, x1 = WINDOW_WIDTH, y1 = WINDOW_HEIGHT;
+    if (dst) {
+        x0 = (float)dst->x;
+        y0 = (float)dst->y;
+        x1 = (float)(dst->x + dst->w);
+        y1 = (float)(dst->y + dst->h);
+    }
+
+    // Mirroring only swaps the texture coordinates
+    float u0 = flip_x ? sprite->u1 : sprite->u0;
+    float u1 = flip_x ? sprite->u0 : sprite->u1;
+
+    SDL_Vertex* v = &vertices[num_quads * 4];
+    v[0].position.x = x0; v[0].position.y = y0; v[0].tex_coord.x = u0; v[0].tex_coord.y = sprite->v0;
+    v[1].position.x = x1; v[1].position.y = y0; v[1].tex_coord.x = u1; v[1].tex_coord.y = sprite->v0;
+    v[2].position.x = x0; v[2].position.y = y1; v[2].tex_coord.x = u0; v[2].tex_coord.y = sprite->v1;
+    v[3].position.x = x1; v[3].position.y = y1; v[3].tex_coord.x = u1; v[3].tex_coord.y = sprite->v1;
+    v[0].color = v[1].color = v[2].color = v[3].color = color;
+
+    num_quads++;
+}
+
+void sprites_begin() {
+    num_quads = 0;
+}
+
+void sprites_draw_ex(int sprite, const SDL_Rect* dst, SDL_Color color, int flip_x) {
+    add_quad(&sprites[sprite], dst, color, flip_x);
+}
+
+void sprites_fill(const SDL_Rect* dst, Uint8 r, Uint8 g, Uint8 b) {
+    SDL_Color color = { r, g, b, 255 };
+    add_quad(&sprites[SPRITE_WHITE], dst, color, FALSE);
+}
+
+int sprites_flush(SDL_Renderer* renderer) {
+    if (num_quads == 0) {
+        return 0;
+    }
+
+    int result = SDL_RenderGeometry(renderer, atlas, vertices, num_quads * 4, indices, num_quads * 6);
+    if (result != 0) {
+        printf("SDL_RenderGeometry: %s\n", SDL_GetError());
+    }
+
+    num_quads = 0;
+    return result;
+}
+
+void sprites_shutdown() {
+    resource_release(atlas);
+    atlas = NULL;
+
+    free(vertices);
+    free(indices);
+    vertices = NULL;
+    indices = NULL;
+    max_quads = 0;
+    num_quads = 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SDL.h>
+
+#include "scene.h"
+
+// Every sprite lives in one atlas texture, built once from the images in assets/.
+// Drawing only appends quads to a vertex buffer, sprites_flush() submits them
+// with a single SDL_RenderGeometry call, so the draw count doesn't grow with the eggs.
+
+// Packs the loaded surfaces (indexed by sprite id, NULL for generated ones) into the atlas
+// and uploads it. Frees the surfaces, returns FALSE if one is missing or the upload fails.
+int sprites_build(SDL_Renderer* renderer, SDL_Surface** surfaces);
+
+// Original size of a sprite in pixels
+void sprites_size(int sprite, int* width, int* height);
+
+// Batching: begin, queue quads in back to front order, flush once per layer
+void sprites_begin();
+void sprites_draw_ex(int sprite, const SDL_Rect* dst, SDL_Color color, int flip_x);   // NULL fills the whole window
+void sprites_fill(const SDL_Rect* dst, Uint8 r, Uint8 g, Uint8 b);
+int sprites_flush(SDL_Renderer* renderer);
+
+// Frees the atlas and the vertex buffer. Call before SDL_DestroyRenderer.
+void sprites_shutdown();
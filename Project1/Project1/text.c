@@ -0,0 +1,371 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Built_in_library
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// User_defined_library
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+// Other_includes
+#include "text.h"
+#include "resources.h"
+
+// Printable ASCII range baked into every atlas
+#define FIRST_GLYPH 32
+#define LAST_GLYPH 126
+#define NUM_GLYPHS (LAST_GLYPH - FIRST_GLYPH + 1)
+
+// Atlas width, rows are packed top to bottom
+#define ATLAS_WIDTH 512
+#define ATLAS_PADDING 1
+
+typedef struct {
+    SDL_Rect src;   // Where the glyph sits inside the atlas
+    int advance;    // How far the pen moves after this glyph
+} Glyph;
+
+typedef struct {
+    char path[260];
+    int size;
+    int pixel_size; // size times the text scale, what the atlas is rasterized at
+    int failed;     // Set when the font couldn't be opened, so we don't retry every frame
+    TTF_Font* font;
+    SDL_Texture* atlas;
+    int atlas_width, atlas_height;
+    int line_height;
+    Glyph glyphs[NUM_GLYPHS];
+} FontEntry;
+
+typedef struct {
+    int in_use;
+    int font;
+    int x, y;
+    Uint8 r, g, b;
+    char text[TEXT_MAX_STRING_LENGTH];
+    int num_quads;
+    Uint32 last_used;
+    SDL_Vertex vertices[TEXT_MAX_STRING_LENGTH * 4];
+} CachedString;
+
+static FontEntry fonts[TEXT_MAX_FONTS];
+static int num_fonts = 0;
+
+static CachedString strings[TEXT_MAX_CACHED_STRINGS];
+static Uint32 use_counter = 0;
+
+// Shared quad indices (0 1 2, 2 1 3 per glyph), filled once
+static int quad_indices[TEXT_MAX_STRING_LENGTH * 6];
+static int indices_ready = 0;
+
+// Screen pixels per unit, glyphs and metrics in the atlases are pixels
+static float text_scale = 1.0f;
+
+static void atlas_key(const FontEntry* entry, char* key, size_t size) {
+    snprintf(key, size, "font:%s:%d", entry->path, entry->pixel_size);
+}
+
+// Sizes that round to the same pixel size rasterize the same glyphs, so they share the atlas
+static int share_atlas(FontEntry* entry) {
+    char key[RESOURCE_MAX_KEY_LENGTH];
+    atlas_key(entry, key, sizeof(key));
+    SDL_Texture* atlas = resource_texture_acquire(key);
+    if (!atlas) {
+        return -1;
+    }
+
+    for (int i = 0; i < num_fonts; i++) {
+        if (&fonts[i] != entry && fonts[i].atlas == atlas) {
+            entry->atlas = atlas;
+            entry->atlas_width = fonts[i].atlas_width;
+            entry->atlas_height = fonts[i].atlas_height;
+            entry->line_height = fonts[i].line_height;
+            memcpy(entry->glyphs, fonts[i].glyphs, sizeof(entry->glyphs));
+            return 0;
+        }
+    }
+
+    // Cached without a font entry to copy the glyphs from
+    resource_release(atlas);
+    return -1;
+}
+
+static int build_atlas(SDL_Renderer* renderer, FontEntry* entry) {
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* glyph_surfaces[NUM_GLYPHS];
+
+    // First pass: rasterize every glyph once and shelf-pack the rects
+    int pen_x = ATLAS_PADDING;
+    int pen_y = ATLAS_PADDING;
+    int row_height = 0;
+
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        Uint16 ch = (Uint16)(FIRST_GLYPH + i);
+        Glyph* glyph = &entry->glyphs[i];
+
+        int minx, maxx, miny, maxy, advance;
+        if (TTF_GlyphMetrics(entry->font, ch, &minx, &maxx, &miny, &maxy, &advance) != 0) {
+            advance = 0;
+        }
+        glyph->advance = advance;
+
+        glyph_surfaces[i] = TTF_RenderGlyph_Blended(entry->font, ch, white);
+        if (!glyph_surfaces[i]) {
+            glyph->src.x = glyph->src.y = glyph->src.w = glyph->src.h = 0;
+            continue;
+        }
+
+        int w = glyph_surfaces[i]->w;
+        int h = glyph_surfaces[i]->h;
+        if (pen_x + w + ATLAS_PADDING > ATLAS_WIDTH) {
+            pen_x = ATLAS_PADDING;
+            pen_y += row_height + ATLAS_PADDING;
+            row_height = 0;
+        }
+
+        glyph->src.x = pen_x;
+        glyph->src.y = pen_y;
+        glyph->src.w = w;
+        glyph->src.h = h;
+
+        pen_x += w + ATLAS_PADDING;
+        if (h > row_height) row_height = h;
+    }
+
+    entry->atlas_width = ATLAS_WIDTH;
+    entry->atlas_height = pen_y + row_height + ATLAS_PADDING;
+
+    // Second pass: copy the glyphs into a single surface and upload it once
+    SDL_Surface* atlas_surface = SDL_CreateRGBSurfaceWithFormat(0, entry->atlas_width, entry->atlas_height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlas_surface) {
+        printf("SDL_CreateRGBSurfaceWithFormat: %s\n", SDL_GetError());
+        for (int i = 0; i < NUM_GLYPHS; i++) SDL_FreeSurface(glyph_surfaces[i]);
+        return -1;
+    }
+
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        if (!glyph_surfaces[i]) continue;
+
+        // Copy alpha as-is instead of blending onto the empty atlas
+        SDL_SetSurfaceBlendMode(glyph_surfaces[i], SDL_BLENDMODE_NONE);
+        SDL_Rect dst = entry->glyphs[i].src;
+        SDL_BlitSurface(glyph_surfaces[i], NULL, atlas_surface, &dst);
+        SDL_FreeSurface(glyph_surfaces[i]);
+    }
+
+    entry->atlas = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+    SDL_FreeSurface(atlas_surface);
+    if (!entry->atlas) {
+        printf("SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    // Owned by the resource cache so it shows up in the texture totals
+    char key[RESOURCE_MAX_KEY_LENGTH];
+    atlas_key(entry, key, sizeof(key));
+    entry->atlas = resource_texture_add(key, entry->atlas);
+    if (!entry->atlas) {
+        return -1;
+    }
+    SDL_SetTextureBlendMode(entry->atlas, SDL_BLENDMODE_BLEND);
+
+    entry->line_height = TTF_FontHeight(entry->font);
+    return 0;
+}
+
+static int open_font(SDL_Renderer* renderer, const char* fontPath, int fontSize) {
+    if (!fontPath) fontPath = TEXT_DEFAULT_FONT;
+
+    for (int i = 0; i < num_fonts; i++) {
+        if (fonts[i].size == fontSize && strcmp(fonts[i].path, fontPath) == 0) {
+            return fonts[i].failed ? -1 : i;
+        }
+    }
+
+    if (num_fonts >= TEXT_MAX_FONTS) {
+        printf("Text: too many fonts, can't open %s\n", fontPath);
+        return -1;
+    }
+
+    FontEntry* entry = &fonts[num_fonts];
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->path, sizeof(entry->path), "%s", fontPath);
+    entry->size = fontSize;
+    entry->pixel_size = (int)(fontSize * text_scale + 0.5f);
+    if (entry->pixel_size < 1) entry->pixel_size = 1;
+
+    if (share_atlas(entry) == 0) {
+        num_fonts++;
+        return num_fonts - 1;
+    }
+
+    entry->font = TTF_OpenFont(fontPath, entry->pixel_size);
+    if (!entry->font) {
+        printf("TTF_OpenFont: %s\n", TTF_GetError());
+        entry->failed = 1;
+    }
+    else if (build_atlas(renderer, entry) != 0) {
+        TTF_CloseFont(entry->font);
+        entry->font = NULL;
+        entry->failed = 1;
+    }
+
+    num_fonts++;
+    return entry->failed ? -1 : num_fonts - 1;
+}
+
+// Looks up the font, falling back to the default font if the requested one is missing
+static int find_font(SDL_Renderer* renderer, const char* fontPath, int fontSize) {
+    int font = open_font(renderer, fontPath, fontSize);
+    if (font < 0 && fontPath && strcmp(fontPath, TEXT_DEFAULT_FONT) != 0) {
+        font = open_font(renderer, TEXT_DEFAULT_FONT, fontSize);
+    }
+    return font;
+}
+
+static const Glyph* get_glyph(const FontEntry* entry, char c) {
+    unsigned char ch = (unsigned char)c;
+    if (ch < FIRST_GLYPH || ch > LAST_GLYPH) ch = '?';
+    return &entry->glyphs[ch - FIRST_GLYPH];
+}
+
+// In units, not atlas pixels
+static void measure(const FontEntry* entry, const char* text, int* width, int* height) {
+    int w = 0;
+    for (const char* c = text; *c; c++) {
+        w += get_glyph(entry, *c)->advance;
+    }
+    if (width) *width = (int)(w / text_scale + 0.5f);
+    if (height) *height = (int)(entry->line_height / text_scale + 0.5f);
+}
+
+static void build_string(CachedString* cached, const FontEntry* entry) {
+    int width, height;
+    measure(entry, cached->text, &width, &height);
+
+    // Center the text on (x, y)
+    float pen_x = (float)(cached->x - width / 2);
+    float pen_y = (float)(cached->y - height / 2);
+
+    float inv_w = 1.0f / entry->atlas_width;
+    float inv_h = 1.0f / entry->atlas_height;
+    float unit = 1.0f / text_scale;
+    SDL_Color color = { cached->r, cached->g, cached->b, 255 };
+
+    cached->num_quads = 0;
+    for (const char* c = cached->text; *c; c++) {
+        const Glyph* glyph = get_glyph(entry, *c);
+
+        if (glyph->src.w > 0 && glyph->src.h > 0) {
+            SDL_Vertex* v = &cached->vertices[cached->num_quads * 4];
+            float x0 = pen_x, y0 = pen_y;
+            float x1 = pen_x + glyph->src.w * unit, y1 = pen_y + glyph->src.h * unit;
+            float u0 = glyph->src.x * inv_w, v0 = glyph->src.y * inv_h;
+            float u1 = (glyph->src.x + glyph->src.w) * inv_w, v1 = (glyph->src.y + glyph->src.h) * inv_h;
+
+            v[0].position.x = x0; v[0].position.y = y0; v[0].tex_coord.x = u0; v[0].tex_coord.y = v0;
+            v[1].position.x = x1; v[1].position.y = y0; v[1].tex_coord.x = u1; v[1].tex_coord.y = v0;
+            v[2].position.x = x0; v[2].position.y = y1; v[2].tex_coord.x = u0; v[2].tex_coord.y = v1;
+            v[3].position.x = x1; v[3].position.y = y1; v[3].tex_coord.x = u1; v[3].tex_coord.y = v1;
+            v[0].color = v[1].color = v[2].color = v[3].color = color;
+
+            cached->num_quads++;
+        }
+
+        pen_x += glyph->advance * unit;
+    }
+}
+
+int text_draw(SDL_Renderer* renderer, const char* fontPath, int fontSize, const char* text, int x, int y, Uint8 r, Uint8 g, Uint8 b) {
+    int font = find_font(renderer, fontPath, fontSize);
+    if (font < 0) {
+        return -1;
+    }
+
+    if (!indices_ready) {
+        for (int i = 0; i < TEXT_MAX_STRING_LENGTH; i++) {
+            quad_indices[i * 6 + 0] = i * 4 + 0;
+            quad_indices[i * 6 + 1] = i * 4 + 1;
+            quad_indices[i * 6 + 2] = i * 4 + 2;
+            quad_indices[i * 6 + 3] = i * 4 + 2;
+            quad_indices[i * 6 + 4] = i * 4 + 1;
+            quad_indices[i * 6 + 5] = i * 4 + 3;
+        }
+        indices_ready = 1;
+    }
+
+    // Reuse the quads if this exact string was drawn recently, otherwise evict the oldest entry
+    CachedString* cached = NULL;
+    CachedString* oldest = &strings[0];
+    for (int i = 0; i < TEXT_MAX_CACHED_STRINGS; i++) {
+        CachedString* s = &strings[i];
+        if (s->in_use && s->font == font && s->x == x && s->y == y &&
+            s->r == r && s->g == g && s->b == b &&
+            strncmp(s->text, text, TEXT_MAX_STRING_LENGTH - 1) == 0) {
+            cached = s;
+            break;
+        }
+        if (!s->in_use || (oldest->in_use && s->last_used < oldest->last_used)) {
+            oldest = s;
+        }
+    }
+
+    if (!cached) {
+        cached = oldest;
+        cached->in_use = 1;
+        cached->font = font;
+        cached->x = x;
+        cached->y = y;
+        cached->r = r;
+        cached->g = g;
+        cached->b = b;
+        snprintf(cached->text, sizeof(cached->text), "%s", text);
+        build_string(cached, &fonts[font]);
+    }
+
+    cached->last_used = ++use_counter;
+
+    if (cached->num_quads == 0) {
+        return 0;
+    }
+
+    if (SDL_RenderGeometry(renderer, fonts[font].atlas, cached->vertices, cached->num_quads * 4, quad_indices, cached->num_quads * 6) != 0) {
+        printf("SDL_RenderGeometry: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    return 0;
+}
+
+int text_measure(SDL_Renderer* renderer, const char* fontPath, int fontSize, const char* text, int* width, int* height) {
+    int font = find_font(renderer, fontPath, fontSize);
+    if (font < 0) {
+        return -1;
+    }
+
+    measure(&fonts[font], text, width, height);
+    return 0;
+}
+
+void text_shutdown() {
+    for (int i = 0; i < num_fonts; i++) {
+        resource_release(fonts[i].atlas);
+        if (fonts[i].font) TTF_CloseFont(fonts[i].font);
+    }
+    memset(fonts, 0, sizeof(fonts));
+    memset(strings, 0, sizeof(strings));
+    num_fonts = 0;
+    use_counter = 0;
+}
+
+void text_set_scale(float scale) {
+    if (scale <= 0.0f || fabsf(scale - text_scale) < 0.001f) {
+        return;
+    }
+
+    // Every atlas was rasterized for the old size
+    text_shutdown();
+    text_scale = scale;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SDL.h>
+
+// Default font used when a requested font can't be opened
+#define TEXT_DEFAULT_FONT "assets/Pixeltype.ttf"
+
+// Limits for the text cache
+#define TEXT_MAX_FONTS 8
+#define TEXT_MAX_CACHED_STRINGS 32
+#define TEXT_MAX_STRING_LENGTH 128
+
+// Draws text centered on (x, y) using a cached glyph atlas for the font / size pair.
+// Fonts are opened once and strings that haven't changed reuse their quads.
+int text_draw(SDL_Renderer* renderer, const char* fontPath, int fontSize, const char* text, int x, int y, Uint8 r, Uint8 g, Uint8 b);
+
+// Measures the text without drawing it
+int text_measure(SDL_Renderer* renderer, const char* fontPath, int fontSize, const char* text, int* width, int* height);
+
+// Screen pixels per unit the text is drawn in (the renderer's scale), fonts are rasterized
+// at fontSize times this so they stay sharp. Changing it drops every font and cached string.
+void text_set_scale(float scale);
+
+// Frees every font, atlas texture and cached string. Call before TTF_Quit.
+void text_shutdown();